@@ -36,3 +36,303 @@ function(get_can_fifo_rx_interrupt ioc_file output)
     set(${output} ${result} PARENT_SCOPE)
 endfunction()
 
+
+# interrupt kinds that follow a peripheral name in a NVIC line, e.g. CAN1_RX0, I2C1_EV, TIM1_UP_TIM10
+function(ioc_irq_flag token output)
+    set(flag "")
+    if(token STREQUAL "RX0")
+        set(flag irqRx0)
+    elseif(token STREQUAL "RX1")
+        set(flag irqRx1)
+    elseif(token STREQUAL "TX")
+        set(flag irqTx)
+    elseif(token STREQUAL "SCE")
+        set(flag irqSce)
+    elseif(token STREQUAL "EV")
+        set(flag irqEvent)
+    elseif(token STREQUAL "ER")
+        set(flag irqError)
+    elseif(token STREQUAL "CC")
+        set(flag irqCapture)
+    elseif(token STREQUAL "UP")
+        set(flag irqUpdate)
+    elseif(token STREQUAL "TRG")
+        set(flag irqTrigger)
+    elseif(token STREQUAL "BRK")
+        set(flag irqBreak)
+    elseif(token STREQUAL "COM")
+        set(flag none)
+    endif()
+    set(${output} ${flag} PARENT_SCOPE)
+endfunction()
+
+# interrupt flags of a peripheral from the enabled NVIC lines
+# names: names of the peripheral in the NVIC lines, e.g. I2S2 and SPI2
+function(ioc_irq_flags irq_lines names output)
+    set(flags "")
+    foreach(line ${irq_lines})
+        string(REPLACE "_" ";" tokens ${line})
+        list(LENGTH tokens n)
+        set(i 0)
+        set(group "")
+        while(i LESS n)
+            list(GET tokens ${i} token)
+            math(EXPR i "${i} + 1")
+
+            # shared lines: ADC1_2 is ADC1 and ADC2, USART3_4 is USART3 and USART4, a plain ADC line is every ADC
+            if(token MATCHES "^([A-Z]+)[0-9]*$")
+                set(group ${CMAKE_MATCH_1})
+            elseif(group AND token MATCHES "^[0-9]+$")
+                set(token "${group}${token}")
+            else()
+                set(group "")
+            endif()
+
+            set(matched FALSE)
+            foreach(name ${names})
+                if(token STREQUAL name OR (token STREQUAL "ADC" AND name MATCHES "^ADC[0-9]*$"))
+                    set(matched TRUE)
+                endif()
+            endforeach()
+            if(NOT matched)
+                continue()
+            endif()
+
+            set(kinds "")
+            while(i LESS n)
+                list(GET tokens ${i} next)
+                ioc_irq_flag(${next} flag)
+                if(NOT flag)
+                    break()
+                endif()
+                if(NOT flag STREQUAL "none")
+                    list(APPEND kinds ${flag})
+                endif()
+                math(EXPR i "${i} + 1")
+            endwhile()
+
+            if(NOT kinds)
+                set(kinds irqGlobal)
+            endif()
+            list(APPEND flags ${kinds})
+        endwhile()
+    endforeach()
+    list(REMOVE_DUPLICATES flags)
+    set(${output} "${flags}" PARENT_SCOPE)
+endfunction()
+
+# C++ expression of a flag list
+function(ioc_flags_expression flags output)
+    if(flags)
+        string(REPLACE ";" " | " expression "${flags}")
+    else()
+        set(expression 0)
+    endif()
+    set(${output} "${expression}" PARENT_SCOPE)
+endfunction()
+
+# write periph/ioc_registry.h: every UART, CAN, TIM, TIM channel, ADC, I2S and I2C instance enabled in the .ioc
+# with its interrupts and DMA requests, see periph/registry.h
+function(generate_periph_registry_header ioc_file output)
+    file(STRINGS ${ioc_file} ip_lines REGEX "^Mcu\\.IP[0-9]+=")
+    file(STRINGS ${ioc_file} nvic_lines REGEX "^NVIC\\.[A-Za-z0-9_]+_IRQn=true")
+    file(STRINGS ${ioc_file} request_lines REGEX "^Dma\\.Request[0-9]+=")
+    file(STRINGS ${ioc_file} dma_lines REGEX "^Dma\\.[A-Za-z0-9_/]+\\.[0-9]+\\.(Mode|Direction)=")
+    file(STRINGS ${ioc_file} channel_lines REGEX "^TIM[0-9]+\\.Channel-.*=TIM_CHANNEL_[1-4]")
+    file(STRINGS ${ioc_file} size_lines REGEX "^ADC[0-9]*\\.NbrOfConversion=[0-9]+")
+
+    set(irq_lines "")
+    foreach(line ${nvic_lines})
+        string(REGEX REPLACE "^NVIC\\.([A-Za-z0-9_]+)_IRQn=.*" "\\1" irq ${line})
+        list(APPEND irq_lines ${irq})
+    endforeach()
+
+    # dma flags of each peripheral, keyed by the request prefix
+    foreach(line ${request_lines})
+        string(REGEX REPLACE "^Dma\\.Request[0-9]+=(.*)$" "\\1" request ${line})
+        set(mode "")
+        set(direction "")
+        foreach(dma_line ${dma_lines})
+            if(dma_line MATCHES "^Dma\\.${request}\\.[0-9]+\\.Mode=(.*)$")
+                set(mode ${CMAKE_MATCH_1})
+            elseif(dma_line MATCHES "^Dma\\.${request}\\.[0-9]+\\.Direction=(.*)$")
+                set(direction ${CMAKE_MATCH_1})
+            endif()
+        endforeach()
+
+        string(REGEX MATCH "^([A-Za-z0-9]+)_?(.*)$" _ ${request})
+        set(peripheral ${CMAKE_MATCH_1})
+        set(suffix ${CMAKE_MATCH_2})
+        if(direction STREQUAL "DMA_MEMORY_TO_PERIPH")
+            set(flag dmaTx)
+        else()
+            set(flag dmaRx)
+        endif()
+
+        if(peripheral MATCHES "^TIM[0-9]+$" AND suffix MATCHES "^CH([1-4])")
+            set(key "${peripheral}_CH${CMAKE_MATCH_1}")
+        elseif(peripheral MATCHES "^TIM[0-9]+$" AND suffix STREQUAL "UP")
+            set(key ${peripheral})
+            set(flag dmaUpdate)
+        elseif(peripheral MATCHES "^TIM[0-9]+$" AND suffix STREQUAL "TRIG")
+            set(key ${peripheral})
+            set(flag dmaTrigger)
+        elseif(peripheral MATCHES "^TIM[0-9]+$")
+            continue()
+        else()
+            set(key ${peripheral})
+        endif()
+
+        list(APPEND dma_${key} ${flag})
+        if(mode STREQUAL "DMA_CIRCULAR" AND flag MATCHES "^dma(Rx|Tx)$")
+            list(APPEND dma_${key} ${flag}Circular)
+        endif()
+    endforeach()
+
+    # instances, as named by the HAL
+    foreach(kind uart can tim adc i2s i2c)
+        set(${kind}_entries "")
+        set(${kind}_cases "")
+        set(${kind}_count 0)
+    endforeach()
+
+    foreach(line ${ip_lines})
+        string(REGEX REPLACE "^Mcu\\.IP[0-9]+=(.*)$" "\\1" ip ${line})
+        set(names ${ip})
+        if(ip MATCHES "^(US|LPU|U)ART[0-9]+$")
+            set(kind uart)
+            set(instance ${ip})
+        elseif(ip MATCHES "^CAN([0-9]*)$")
+            set(kind can)
+            set(instance CAN1)
+            if(CMAKE_MATCH_1)
+                set(instance ${ip})
+            endif()
+            list(APPEND names ${instance})
+        elseif(ip MATCHES "^TIM[0-9]+$")
+            set(kind tim)
+            set(instance ${ip})
+        elseif(ip MATCHES "^ADC([0-9]*)$")
+            set(kind adc)
+            set(instance ADC1)
+            if(CMAKE_MATCH_1)
+                set(instance ${ip})
+            endif()
+            list(APPEND names ${instance})
+        elseif(ip MATCHES "^I2S([0-9]+)$")
+            set(kind i2s)
+            set(instance SPI${CMAKE_MATCH_1})
+            list(APPEND names ${instance})
+        elseif(ip MATCHES "^I2C[0-9]+$")
+            set(kind i2c)
+            set(instance ${ip})
+        else()
+            continue()
+        endif()
+
+        ioc_irq_flags("${irq_lines}" "${names}" irq)
+        set(dma "")
+        foreach(name ${names})
+            list(APPEND dma ${dma_${name}})
+        endforeach()
+        if(dma)
+            list(REMOVE_DUPLICATES dma)
+        endif()
+        ioc_flags_expression("${irq}" irq)
+        ioc_flags_expression("${dma}" dma)
+
+        # buffer size, the number of regular conversions of an ADC
+        set(size 0)
+        foreach(size_line ${size_lines})
+            if(size_line MATCHES "^${ip}\\.NbrOfConversion=([0-9]+)")
+                set(size ${CMAKE_MATCH_1})
+            endif()
+        endforeach()
+
+        string(APPEND ${kind}_entries "            {\"${ip}\", ${instance}_BASE, ${irq}, ${dma}, ${size}},\n")
+        string(APPEND ${kind}_cases "                case ${instance}_BASE: return ${${kind}_count};\n")
+        math(EXPR ${kind}_count "${${kind}_count} + 1")
+        message(STATUS "periph registry: ${ip} irq ${irq} dma ${dma} size ${size}")
+    endforeach()
+
+    # timer channels
+    set(channel_entries "")
+    set(channel_keys "")
+    set(channel_count 0)
+    foreach(line ${channel_lines})
+        string(REGEX MATCH "^(TIM[0-9]+)\\.Channel-(.*)=TIM_CHANNEL_([1-4])" _ ${line})
+        set(tim ${CMAKE_MATCH_1})
+        set(function ${CMAKE_MATCH_2})
+        set(channel ${CMAKE_MATCH_3})
+        list(FIND channel_keys "${tim}_CH${channel}" found)
+        if(NOT found EQUAL -1)
+            continue()
+        endif()
+        list(APPEND channel_keys "${tim}_CH${channel}")
+
+        if(function MATCHES "PWM")
+            set(mode modePwm)
+        elseif(function MATCHES "Input.Capture")
+            set(mode modeCapture)
+        elseif(function MATCHES "Output")
+            set(mode modeCompare)
+        else()
+            set(mode modeOther)
+        endif()
+        ioc_flags_expression("${dma_${tim}_CH${channel}}" dma)
+
+        string(APPEND channel_entries "            {\"${tim}\", ${tim}_BASE, TIM_CHANNEL_${channel}, ${mode}, ${dma}},\n")
+        math(EXPR channel_count "${channel_count} + 1")
+    endforeach()
+
+    # header
+    get_filename_component(ioc_name ${ioc_file} NAME)
+    set(content "// generated from ${ioc_name} by generate_periph_registry() in cmake/ioc_parser.cmake, do not edit\n")
+    string(APPEND content "#ifndef PERIPH_IOC_REGISTRY_H\n#define PERIPH_IOC_REGISTRY_H\n\n")
+    string(APPEND content "namespace Project::periph::registry {\n")
+
+    foreach(pair "uart;Uart" "can;Can" "tim;Tim" "adc;Adc" "i2s;I2s" "i2c;I2c")
+        list(GET pair 0 kind)
+        list(GET pair 1 type)
+        set(entries "${${kind}_entries}")
+        if(NOT entries)
+            set(entries "            {},\n")
+        endif()
+
+        string(APPEND content "    struct ${type} {\n")
+        string(APPEND content "        static constexpr size_t count = ${${kind}_count};\n")
+        string(APPEND content "        static constexpr Entry entries[] = {\n${entries}        };\n\n")
+        if(${kind}_count GREATER 0)
+            string(APPEND content "        static constexpr int index(uintptr_t base) {\n")
+            string(APPEND content "            switch (base) {\n${${kind}_cases}                default: return -1;\n            }\n        }\n")
+        else()
+            string(APPEND content "        static constexpr int index(uintptr_t) { return -1; }\n")
+        endif()
+        string(APPEND content "    };\n\n")
+    endforeach()
+
+    if(NOT channel_entries)
+        set(channel_entries "            {},\n")
+    endif()
+    string(APPEND content "    struct TimChannels {\n")
+    string(APPEND content "        static constexpr size_t count = ${channel_count};\n")
+    string(APPEND content "        static constexpr TimChannel entries[] = {\n${channel_entries}        };\n    };\n")
+    string(APPEND content "}\n\n#endif // PERIPH_IOC_REGISTRY_H\n")
+
+    # only touch the header when it changes
+    file(WRITE ${output}.tmp "${content}")
+    configure_file(${output}.tmp ${output} COPYONLY)
+    file(REMOVE ${output}.tmp)
+endfunction()
+
+# generate periph/ioc_registry.h from the .ioc and bind the periph drivers of target to it.
+# drivers then dispatch interrupts by direct indexing and check their configuration at compile time
+# example:
+#   generate_periph_registry(${CMAKE_SOURCE_DIR}/project.ioc periph)
+function(generate_periph_registry ioc_file target)
+    set(dir ${CMAKE_CURRENT_BINARY_DIR}/periph_registry)
+    generate_periph_registry_header(${ioc_file} ${dir}/periph/ioc_registry.h)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${ioc_file})
+    target_include_directories(${target} PUBLIC ${dir})
+    target_compile_definitions(${target} PUBLIC -DPERIPH_USE_REGISTRY)
+endfunction()
@@ -1,4 +1,5 @@
 #include "periph/adc.h"
+#include "periph/trace.h"
 
 #ifdef HAL_ADC_MODULE_ENABLED
 
@@ -6,7 +7,16 @@ using namespace Project::periph;
 
 detail::UniqueInstances<ADCD*, 3> ADCD::Instances;
 
+#ifdef PERIPH_USE_REGISTRY
+registry::Slots<ADCD, registry::Adc> ADCD::Registered;
+
+static_assert(registry::any<registry::Adc>(0, registry::dmaRx | registry::dmaRxCircular), "ADC driver needs a circular ADC DMA request in the .ioc");
+#endif
+
 static ADCD* selector(ADC_HandleTypeDef* hadc) {
+    #ifdef PERIPH_USE_REGISTRY
+    return ADCD::Registered.find(hadc->Instance);
+    #else
     for (auto instance : ADCD::Instances.instances) {
         if (instance == nullptr)
             continue;
@@ -16,13 +26,16 @@ static ADCD* selector(ADC_HandleTypeDef* hadc) {
     }
 
     return nullptr;
+    #endif
 }
 
 extern "C" void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc) {
+    PERIPH_TRACE(trace::sourceAdc);
     auto adc = selector(hadc);
     if (adc == nullptr)
         return;
 
+    PERIPH_TRACE(trace::sourceAdcUser);
     for (auto& callback : adc->callbackList.instances)
         callback();
 }
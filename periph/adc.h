@@ -5,6 +5,7 @@
 #ifdef HAL_ADC_MODULE_ENABLED
 
 #include "periph/config.h"
+#include "periph/registry.h"
 #include "Core/Inc/adc.h"
 #include "etl/array.h"
 #include "etl/function.h"
@@ -21,7 +22,14 @@ struct Project::periph::ADCD {
     using Callback = etl::Function<void(), void*>;
     using CallbackList = detail::UniqueInstances<Callback, PERIPH_CALLBACK_LIST_MAX_SIZE>;
     static detail::UniqueInstances<ADCD*, 3> Instances;
+    #ifdef PERIPH_USE_REGISTRY
+    static registry::Slots<ADCD, registry::Adc> Registered; ///< instances indexed by the registry position of hadc.Instance
+    #endif
+    #ifdef PERIPH_ADC_N_CHANNEL
     static const size_t N_CHANNEL = PERIPH_ADC_N_CHANNEL;
+    #else
+    static const size_t N_CHANNEL = registry::maxSize<registry::Adc>() > 0 ? registry::maxSize<registry::Adc>() : 1; ///< largest number of regular conversions in the .ioc
+    #endif
 
     ADC_HandleTypeDef &hadc;                    ///< ADC handler generated by cubeMX
     etl::Array<uint32_t, N_CHANNEL> buf = {};   ///< ADC buffer
@@ -32,9 +40,12 @@ struct Project::periph::ADCD {
 
     /// start ADC DMA circular
     void init() {
-        HAL_ADC_Start_DMA(&hadc, buf.begin(), N_CHANNEL);
+        HAL_ADC_Start_DMA(&hadc, buf.begin(), conversions());
         __HAL_DMA_DISABLE_IT(hadc.DMA_Handle, DMA_IT_HT); // disable half complete
         Instances.push(this);
+        #ifdef PERIPH_USE_REGISTRY
+        Registered.bind(hadc.Instance, this);
+        #endif
     }
 
     struct InitArgs { Callback callback; };
@@ -48,6 +59,9 @@ struct Project::periph::ADCD {
         if (callbackList.isEmpty()) {
             HAL_ADC_Stop_DMA(&hadc); 
             Instances.pop(this);
+            #ifdef PERIPH_USE_REGISTRY
+            Registered.unbind(hadc.Instance, this);
+            #endif
         }
     }
 
@@ -57,6 +71,17 @@ struct Project::periph::ADCD {
         deinit();
     }
 
+    /// number of regular conversions of this instance: its .ioc entry with PERIPH_USE_REGISTRY, N_CHANNEL otherwise
+    [[nodiscard]]
+    size_t conversions() const {
+        #ifdef PERIPH_USE_REGISTRY
+        int i = registry::Adc::index(reinterpret_cast<uintptr_t>(hadc.Instance));
+        if (i >= 0 && registry::Adc::entries[i].size > 0 && registry::Adc::entries[i].size <= N_CHANNEL)
+            return registry::Adc::entries[i].size;
+        #endif
+        return N_CHANNEL;
+    }
+
     /// get ADC raw value given the index
     uint32_t operator[](int index) const { return buf[index]; }
 
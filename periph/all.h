@@ -3,16 +3,35 @@
 
 #include "periph/adc.h"
 #include "periph/can.h"
+#include "periph/coroutine.h"
 #include "periph/bootloader.h"
+#include "periph/eeprom.h"
 #include "periph/encoder.h"
+#include "periph/event_loop.h"
 #include "periph/exti.h"
+#include "periph/foc.h"
 #include "periph/gpio.h"
+#include "periph/gpio_pin.h"
+#include "periph/gpio_sampler.h"
 #include "periph/i2c.h"
+#include "periph/i2c_poller.h"
 #include "periph/i2s.h"
+#include "periph/iap.h"
 #include "periph/input_capture.h"
+#include "periph/input_capture_ring.h"
+#include "periph/inverter.h"
+#include "periph/pool.h"
 #include "periph/pwm.h"
+#include "periph/pwm_group.h"
+#include "periph/pwm_stream.h"
+#include "periph/registry.h"
+#include "periph/ring.h"
 #include "periph/rtc.h"
+#include "periph/tim_router.h"
+#include "periph/timer_group.h"
+#include "periph/trace.h"
 #include "periph/uart.h"
 #include "periph/usb.h"
+#include "periph/work_queue.h"
 
 #endif // PERIPH_ALL_H
\ No newline at end of file
@@ -1,7 +1,6 @@
 #include "periph/bootloader.h"
 #include "periph/usb.h"
 #include "Core/Inc/tim.h"
-#include "FreeRTOS.h"
 
 using namespace Project;
 
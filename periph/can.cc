@@ -1,12 +1,28 @@
 #include "periph/can.h"
+#include "periph/trace.h"
 
 #ifdef HAL_CAN_MODULE_ENABLED
 
 using namespace Project::periph;
 
 detail::UniqueInstances<CAN*, 3> CAN::Instances;
+CAN::MessagePool CAN::messagePool;
+
+#ifdef PERIPH_USE_REGISTRY
+registry::Slots<CAN, registry::Can> CAN::Registered;
+
+#ifdef PERIPH_CAN_USE_FIFO0
+static_assert(registry::any<registry::Can>(registry::irqRx0, 0), "PERIPH_CAN_USE_FIFO0 needs a CAN RX0 interrupt in the .ioc");
+#endif
+#ifdef PERIPH_CAN_USE_FIFO1
+static_assert(registry::any<registry::Can>(registry::irqRx1, 0), "PERIPH_CAN_USE_FIFO1 needs a CAN RX1 interrupt in the .ioc");
+#endif
+#endif
 
 static CAN* selector(CAN_HandleTypeDef *hcan_) {
+    #ifdef PERIPH_USE_REGISTRY
+    return CAN::Registered.find(hcan_->Instance);
+    #else
     for (auto instance : CAN::Instances.instances) {
         if (instance == nullptr)
             continue;
@@ -16,24 +32,42 @@ static CAN* selector(CAN_HandleTypeDef *hcan_) {
     }
 
     return nullptr;
+    #endif
 }
 
-extern "C" 
-#ifdef PERIPH_CAN_USE_FIFO0
-void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan_) {
-#endif
-#ifdef PERIPH_CAN_USE_FIFO1
-void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan_) {
-#endif
-    
+static void receive(CAN_HandleTypeDef *hcan_, uint32_t fifo) {
+    PERIPH_TRACE(trace::sourceCan);
     auto can = selector(hcan_);
     if (can == nullptr)
         return;
 
-    CAN::Message msg = {};
-    HAL_CAN_GetRxMessage(&can->hcan, CAN::RX_FIFO, reinterpret_cast<CAN_RxHeaderTypeDef *>(&msg), msg.data);
+    // read the frame straight into a pool block if someone takes ownership of it
+    CAN::Message local = {};
+    CAN::Message* msg = &local;
+    if (can->rxPooledCallback) {
+        if (auto block = CAN::messagePool.allocate())
+            msg = block;
+    }
+
+    HAL_CAN_GetRxMessage(&can->hcan, fifo, static_cast<CAN_RxHeaderTypeDef *>(msg), msg->data);
+    PERIPH_TRACE(trace::sourceCanUser);
     for (auto& callback : can->rxCallbackList.instances)
-        callback(msg);
+        callback(*msg);
+
+    if (msg != &local)
+        can->rxPooledCallback(msg);
+}
+
+#if defined(PERIPH_CAN_USE_FIFO0) || defined(PERIPH_CAN_USE_FIFO_AUTO)
+extern "C" void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan_) {
+    receive(hcan_, CAN_RX_FIFO0);
 }
+#endif
+
+#if defined(PERIPH_CAN_USE_FIFO1) || defined(PERIPH_CAN_USE_FIFO_AUTO)
+extern "C" void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan_) {
+    receive(hcan_, CAN_RX_FIFO1);
+}
+#endif
 
 #endif
@@ -5,6 +5,8 @@
 #ifdef HAL_CAN_MODULE_ENABLED
 
 #include "periph/config.h"
+#include "periph/registry.h"
+#include "periph/pool.h"
 #include "Core/Inc/can.h"
 #include "etl/function.h"
 #include "etl/getter_setter.h"
@@ -18,11 +20,17 @@ struct Project::periph::CAN {
     struct Message : CAN_RxHeaderTypeDef { uint8_t data[8]; };
     using Callback = etl::Function<void(Message &), void*>;
     using CallbackList = detail::UniqueInstances<Callback, PERIPH_CALLBACK_LIST_MAX_SIZE>;
+    using MessagePool = Pool<Message, PERIPH_CAN_MESSAGE_POOL_SIZE>;
+    using PooledCallback = etl::Function<void(Message*), void*>;
 
     template <typename T>
     using GetterSetter = etl::GetterSetter<T, etl::Function<T(), const CAN*>, etl::Function<void(T), CAN*>>;
 
     static detail::UniqueInstances<CAN*, 3> Instances;
+    #ifdef PERIPH_USE_REGISTRY
+    static registry::Slots<CAN, registry::Can> Registered; ///< instances indexed by the registry position of hcan.Instance
+    #endif
+    static MessagePool messagePool; ///< received frames handed to rxPooledCallback, shared by all CAN instances
     
     enum {
         #ifdef PERIPH_CAN_USE_FIFO0
@@ -42,16 +50,34 @@ struct Project::periph::CAN {
     CAN_TxHeaderTypeDef txHeader = {};
     uint32_t txMailbox = {};
     CallbackList rxCallbackList = {};
+    PooledCallback rxPooledCallback = {};   ///< takes ownership of each received frame, release it with messagePool.release()
 
     CAN(const CAN&) = delete;               ///< disable copy constructor
     CAN& operator=(const CAN&) = delete;    ///< disable copy assignment
 
+    /// RX FIFO of this instance, CAN_RX_FIFO0 or CAN_RX_FIFO1, see PERIPH_CAN_USE_FIFOx
+    [[nodiscard]]
+    uint32_t rxFifo() const {
+        #if defined(PERIPH_CAN_USE_FIFO_AUTO) && defined(PERIPH_USE_REGISTRY)
+        auto base = reinterpret_cast<uintptr_t>(hcan.Instance);
+        bool onlyFifo0 = registry::has<registry::Can>(base, registry::irqRx0) && !registry::has<registry::Can>(base, registry::irqRx1);
+        return onlyFifo0 ? CAN_RX_FIFO0 : CAN_RX_FIFO1;
+        #elif defined(PERIPH_CAN_USE_FIFO_AUTO)
+        return CAN_RX_FIFO1;
+        #else
+        return RX_FIFO;
+        #endif
+    }
+
     void init() {
         txHeader.RTR = CAN_RTR_DATA;
         txHeader.TransmitGlobalTime = DISABLE;
         HAL_CAN_Start(&hcan);
-        HAL_CAN_ActivateNotification(&hcan, IT_RX_FIFO);
+        HAL_CAN_ActivateNotification(&hcan, rxFifo() == CAN_RX_FIFO0 ? CAN_IT_RX_FIFO0_MSG_PENDING : CAN_IT_RX_FIFO1_MSG_PENDING);
         Instances.push(this);
+        #ifdef PERIPH_USE_REGISTRY
+        Registered.bind(hcan.Instance, this);
+        #endif
     }
 
     struct InitArgs { uint32_t idType, idTx, filter, mask; Callback rxCallback = {}; };
@@ -76,6 +102,9 @@ struct Project::periph::CAN {
         if (rxCallbackList.isEmpty()) {
             HAL_CAN_Stop(&hcan); 
             Instances.pop(this);
+            #ifdef PERIPH_USE_REGISTRY
+            Registered.unbind(hcan.Instance, this);
+            #endif
         }
     }
     struct DeinitArgs { Callback rxCallback; };
@@ -204,7 +233,7 @@ struct Project::periph::CAN {
 private:
     void configureFilter() {
         canFilter.FilterActivation = CAN_FILTER_ENABLE;
-        canFilter.FilterFIFOAssignment = FILTER_FIFO;
+        canFilter.FilterFIFOAssignment = rxFifo() == CAN_RX_FIFO0 ? CAN_FILTER_FIFO0 : CAN_FILTER_FIFO1;
         canFilter.FilterMode = CAN_FILTERMODE_IDMASK;
         canFilter.FilterScale = CAN_FILTERSCALE_32BIT;
         canFilter.FilterBank = 10;
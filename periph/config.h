@@ -6,14 +6,40 @@
 #define PERIPH_CALLBACK_LIST_MAX_SIZE 16
 #endif
 
+// transfer modes
+// PERIPH_xxx_USE_AUTO: IT or DMA per instance, DMA where the .ioc registry lists the request (see periph/registry.h),
+// or without the registry, where cubeMX has linked a DMA handle. it is the default with PERIPH_USE_REGISTRY
+
 // Timebase source
 #if !defined(PERIPH_SYSTICK_TIM_BASE_SOURCE)
 // example:
 // #define PERIPH_SYSTICK_TIM_BASE_SOURCE TIM14
 #endif
 
+// RTOS
+// PERIPH_USE_BARE_METAL: no CMSIS-RTOS2, work queues, timers and coroutines are dispatched by EventLoop::run() (see periph/event_loop.h).
+// it is defined when cmsis_os2.h is not on the include path, so a project without the RTOS builds without configuration
+#if !defined(PERIPH_USE_BARE_METAL) && defined(__has_include)
+#if !__has_include("cmsis_os2.h")
+#define PERIPH_USE_BARE_METAL
+#endif
+#endif
+
+// Tick
+// PERIPH_TICK_RATE_HZ: rate of the etl::Time ticks, i.e. the kernel tick. default configTICK_RATE_HZ when it is visible here, else 1000.
+// define it when the kernel tick is not 1 kHz. delays and timeouts given as etl::Time are compared with HAL_GetTick() milliseconds
+// through detail::tickToMillis()
+#if !defined(PERIPH_TICK_RATE_HZ)
+#if defined(configTICK_RATE_HZ)
+#define PERIPH_TICK_RATE_HZ configTICK_RATE_HZ
+#else
+#define PERIPH_TICK_RATE_HZ 1000
+#endif
+#endif
+
 // ADC
-#if !defined(PERIPH_ADC_N_CHANNEL)
+// with PERIPH_USE_REGISTRY the default is the largest number of regular conversions in the .ioc
+#if !defined(PERIPH_ADC_N_CHANNEL) && !defined(PERIPH_USE_REGISTRY)
 #define PERIPH_ADC_N_CHANNEL 4
 #endif
 
@@ -26,29 +52,98 @@
 #endif
 
 // CAN
-#if !defined(PERIPH_CAN_USE_FIFO0) && !defined(PERIPH_CAN_USE_FIFO1)
+// PERIPH_CAN_USE_FIFO_AUTO: RX FIFO per instance, FIFO1 unless the .ioc registry only enables the RX0 interrupt
+#if !defined(PERIPH_CAN_USE_FIFO0) && !defined(PERIPH_CAN_USE_FIFO1) && !defined(PERIPH_CAN_USE_FIFO_AUTO)
+#if defined(PERIPH_USE_REGISTRY)
+#define PERIPH_CAN_USE_FIFO_AUTO
+#else
 #define PERIPH_CAN_USE_FIFO1
 #endif
+#endif
+
+#if !defined(PERIPH_CAN_MESSAGE_POOL_SIZE)
+#define PERIPH_CAN_MESSAGE_POOL_SIZE 16
+#endif
+
+// coroutine
+// frames are fixed size blocks, coro::largestFrame records the biggest frame requested
+#if !defined(PERIPH_CORO_FRAME_SIZE)
+#define PERIPH_CORO_FRAME_SIZE 256
+#endif
+
+#if !defined(PERIPH_CORO_FRAME_COUNT)
+#define PERIPH_CORO_FRAME_COUNT 8
+#endif
+
+// power of two, at least PERIPH_CORO_FRAME_COUNT so an interrupt can always schedule a waiting coroutine
+#if !defined(PERIPH_CORO_READY_QUEUE_SIZE)
+#define PERIPH_CORO_READY_QUEUE_SIZE 8
+#endif
 
 // TIM encoder
-#if !defined(PERIPH_ENCODER_USE_IT) && !defined(PERIPH_ENCODER_USE_DMA)
+#if !defined(PERIPH_ENCODER_USE_IT) && !defined(PERIPH_ENCODER_USE_DMA) && !defined(PERIPH_ENCODER_USE_POLLING)
 #define PERIPH_ENCODER_USE_IT
 #endif
 
 // TIM input capture
-#if !defined(PERIPH_INPUT_CAPTURE_USE_IT) && !defined(PERIPH_INPUT_CAPTURE_USE_DMA)
+#if !defined(PERIPH_INPUT_CAPTURE_USE_IT) && !defined(PERIPH_INPUT_CAPTURE_USE_DMA) && !defined(PERIPH_INPUT_CAPTURE_USE_AUTO)
+#if defined(PERIPH_USE_REGISTRY)
+#define PERIPH_INPUT_CAPTURE_USE_AUTO
+#else
 #define PERIPH_INPUT_CAPTURE_USE_IT
 #endif
+#endif
+
+// TIM interrupt router
+#if !defined(PERIPH_TIM_ROUTER_MAX_TIMERS)
+#define PERIPH_TIM_ROUTER_MAX_TIMERS 12
+#endif
 
 // TIM PWM 
-#if !defined(PERIPH_PWM_USE_IT) && !defined(PERIPH_PWM_USE_DMA)
+#if !defined(PERIPH_PWM_USE_IT) && !defined(PERIPH_PWM_USE_DMA) && !defined(PERIPH_PWM_USE_AUTO)
+#if defined(PERIPH_USE_REGISTRY)
+#define PERIPH_PWM_USE_AUTO
+#else
 #define PERIPH_PWM_USE_IT
 #endif
+#endif
+
+// event loop
+#if !defined(PERIPH_EVENT_LOOP_MAX_QUEUES)
+#define PERIPH_EVENT_LOOP_MAX_QUEUES 4
+#endif
+
+#if !defined(PERIPH_EVENT_LOOP_MAX_TIMERS)
+#define PERIPH_EVENT_LOOP_MAX_TIMERS 16
+#endif
+
+// EXTI
+#if !defined(PERIPH_EXTI_MAX_CALLBACKS_PER_LINE)
+#define PERIPH_EXTI_MAX_CALLBACKS_PER_LINE 4
+#endif
+
+#if !defined(PERIPH_EXTI_EVENT_RING_SIZE)
+#define PERIPH_EXTI_EVENT_RING_SIZE 64
+#endif
 
 // I2C
-#if !defined(PERIPH_I2C_MEM_WRITE_USE_IT) && !defined(PERIPH_I2C_MEM_WRITE_USE_DMA)
+#if !defined(PERIPH_I2C_MEM_WRITE_USE_IT) && !defined(PERIPH_I2C_MEM_WRITE_USE_DMA) && !defined(PERIPH_I2C_MEM_WRITE_USE_AUTO)
+#if defined(PERIPH_USE_REGISTRY)
+#define PERIPH_I2C_MEM_WRITE_USE_AUTO
+#else
 #define PERIPH_I2C_MEM_WRITE_USE_DMA
 #endif
+#endif
+
+#if !defined(PERIPH_I2C_POLLER_MAX_DEVICES)
+#define PERIPH_I2C_POLLER_MAX_DEVICES 16
+#endif
+
+// IAP
+// PERIPH_IAP_USE_CUSTOM_BACKEND: no HAL flash backend, IAP::backend has to be set. required outside STM32F1 to F4
+#if !defined(PERIPH_IAP_BLOCK_SIZE)
+#define PERIPH_IAP_BLOCK_SIZE 1024
+#endif
 
 // I2S
 #if !defined(PERIPH_I2S_AUDIO_RATE)
@@ -65,20 +160,79 @@
 
 #define PERIPH_I2S_SAMPLING_TIME ((double) PERIPH_I2S_N_SAMPLES / (double) PERIPH_I2S_AUDIO_RATE)
 
+// trace
+// PERIPH_USE_TRACE: measure HAL callbacks and user callbacks with the DWT cycle counter, see periph/trace.h
+#if !defined(PERIPH_TRACE_APP_SOURCES)
+#define PERIPH_TRACE_APP_SOURCES 8
+#endif
+
 // UART
-#if !defined(PERIPH_UART_RECEIVE_USE_IT) && !defined(PERIPH_UART_RECEIVE_USE_DMA)
+#if !defined(PERIPH_UART_RECEIVE_USE_IT) && !defined(PERIPH_UART_RECEIVE_USE_DMA) && !defined(PERIPH_UART_RECEIVE_USE_AUTO)
+#if defined(PERIPH_USE_REGISTRY)
+#define PERIPH_UART_RECEIVE_USE_AUTO
+#else
 #define PERIPH_UART_RECEIVE_USE_IT
 #endif
+#endif
 
-#if !defined(PERIPH_UART_TRANSMIT_USE_IT) && !defined(PERIPH_UART_TRANSMIT_USE_DMA)
+#if !defined(PERIPH_UART_TRANSMIT_USE_IT) && !defined(PERIPH_UART_TRANSMIT_USE_DMA) && !defined(PERIPH_UART_TRANSMIT_USE_AUTO)
+#if defined(PERIPH_USE_REGISTRY)
+#define PERIPH_UART_TRANSMIT_USE_AUTO
+#else
 #define PERIPH_UART_TRANSMIT_USE_IT
 #endif
+#endif
 
 #if !defined(PERIPH_UART_RX_BUFFER_SIZE)
 #define PERIPH_UART_RX_BUFFER_SIZE 64
 #endif
 
+#if !defined(PERIPH_UART_FRAME_POOL_SIZE)
+#define PERIPH_UART_FRAME_POOL_SIZE 8
+#endif
+
+// USB
+#if !defined(PERIPH_USB_TX_RING_SIZE)
+#define PERIPH_USB_TX_RING_SIZE 2048
+#endif
+
+#if !defined(PERIPH_USB_TX_ZERO_COPY_SIZE)
+#define PERIPH_USB_TX_ZERO_COPY_SIZE 512
+#endif
+
+// PERIPH_USB_RX_USE_RING: copy OUT packets into a ring and re-arm the endpoint only when the ring has room.
+// CDC_Receive_FS must not call USBD_CDC_ReceivePacket itself
+#if defined(PERIPH_USB_RX_USE_RING) && !defined(PERIPH_USB_RX_RING_SIZE)
+#define PERIPH_USB_RX_RING_SIZE 1024
+#endif
+
+// work queue
+#if !defined(PERIPH_WORK_QUEUE_SIZE)
+#define PERIPH_WORK_QUEUE_SIZE 32
+#endif
+
+#if !defined(PERIPH_WORK_QUEUE_PAYLOAD_SIZE)
+#define PERIPH_WORK_QUEUE_PAYLOAD_SIZE 64
+#endif
+
+#include <cstdint>
+
 namespace Project::periph::detail {
+    /// etl::Time ticks to HAL_GetTick() milliseconds, rounded up so a delay is never shortened.
+    /// 0xFFFFFFFF (etl::time::infinite) stays infinite
+    constexpr uint32_t tickToMillis(uint32_t tick) {
+        if (tick == 0xFFFFFFFF) return tick;
+        uint64_t ms = (uint64_t(tick) * 1000 + (PERIPH_TICK_RATE_HZ) - 1) / (PERIPH_TICK_RATE_HZ);
+        return ms < 0xFFFFFFFF ? uint32_t(ms) : 0xFFFFFFFE;
+    }
+
+    /// HAL_GetTick() milliseconds to etl::Time ticks, rounded up. 0xFFFFFFFF stays infinite
+    constexpr uint32_t millisToTick(uint32_t ms) {
+        if (ms == 0xFFFFFFFF) return ms;
+        uint64_t tick = (uint64_t(ms) * (PERIPH_TICK_RATE_HZ) + 999) / 1000;
+        return tick < 0xFFFFFFFF ? uint32_t(tick) : 0xFFFFFFFE;
+    }
+
     template <typename T, unsigned int N> 
     class UniqueInstances {
     public:
@@ -0,0 +1,55 @@
+#include "periph/coroutine.h"
+
+#ifdef PERIPH_USE_COROUTINE
+
+using namespace Project::periph;
+
+Pool<coro::Frame, PERIPH_CORO_FRAME_COUNT> coro::frames;
+volatile uint32_t coro::largestFrame;
+coro::Scheduler coro::scheduler;
+
+uint32_t coro::Scheduler::run() {
+    // completed waiters stay listed until their coroutine resumes and removes itself
+    uint32_t now = HAL_GetTick();
+    for (Waiter* w = waiters; w != nullptr; w = w->next) {
+        if (w->state.load(std::memory_order_relaxed) != Waiter::statePending)
+            continue;
+
+        if (w->poll && w->poll(w))
+            w->finish(Waiter::stateDone);
+        else if (w->timeout != etl::time::infinite.tick && now - w->start >= w->timeout && w->finish(Waiter::stateTimeout) && w->cancel)
+            w->cancel(w);
+    }
+
+    // coroutines queued while these run wait for the next call
+    for (size_t n = ready.size(); n > 0; --n) {
+        void* address;
+        if (!ready.pop(address))
+            break;
+        std::coroutine_handle<>::from_address(address).resume();
+    }
+
+    if (ready.size() > 0)
+        return 0;
+
+    uint32_t res = etl::time::infinite.tick;
+    now = HAL_GetTick();
+    for (Waiter* w = waiters; w != nullptr; w = w->next) {
+        if (w->state.load(std::memory_order_relaxed) != Waiter::statePending)
+            return 0;
+
+        uint32_t left = res;
+        if (w->poll)
+            left = 1;
+        else if (w->timeout != etl::time::infinite.tick)
+            left = now - w->start >= w->timeout ? 0 : w->timeout - (now - w->start);
+
+        if (left < res)
+            res = left;
+    }
+
+    // the deadlines are HAL milliseconds, the caller waits in kernel ticks
+    return periph::detail::millisToTick(res);
+}
+
+#endif // PERIPH_USE_COROUTINE
@@ -0,0 +1,546 @@
+#ifndef PERIPH_COROUTINE_H
+#define PERIPH_COROUTINE_H
+
+#include "main.h"
+#include "periph/config.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define PERIPH_USE_COROUTINE
+
+#include "periph/pool.h"
+#include "periph/ring.h"
+#include "periph/uart.h"
+#include "periph/i2c.h"
+#include "periph/can.h"
+#include "periph/i2s.h"
+#include "etl/function.h"
+#include "etl/time.h"
+#include <coroutine>
+#include <cstring>
+
+namespace Project::periph::coro {
+    struct Task;
+    struct Scheduler;
+    struct Waiter;
+    struct Sleep;
+    #ifdef HAL_UART_MODULE_ENABLED
+    struct UartTransmit;
+    struct UartReceive;
+    #endif
+    #ifdef HAL_I2C_MODULE_ENABLED
+    struct I2cTransfer;
+    #endif
+    #ifdef HAL_CAN_MODULE_ENABLED
+    template <typename Args> struct CanTransmit;
+    struct CanReceive;
+    #endif
+    #ifdef HAL_I2S_MODULE_ENABLED
+    struct I2sBlock;
+    #endif
+
+    /// coroutine frame storage
+    struct alignas(8) Frame { uint8_t bytes[PERIPH_CORO_FRAME_SIZE]; };
+
+    extern Pool<Frame, PERIPH_CORO_FRAME_COUNT> frames;
+    extern volatile uint32_t largestFrame;  ///< biggest frame requested, tune PERIPH_CORO_FRAME_SIZE with it
+    extern Scheduler scheduler;
+
+    static_assert(PERIPH_CORO_READY_QUEUE_SIZE >= PERIPH_CORO_FRAME_COUNT, "every coroutine must fit the ready queue");
+
+    namespace detail {
+        template <typename F>
+        void critical(F&& fn) {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            fn();
+            __set_PRIMASK(primask);
+        }
+    }
+}
+
+/// detached coroutine, its frame comes from coro::frames and is released when it returns.
+/// it runs in the caller up to its first co_await, then in the task calling coro::scheduler.run()
+/// @note requirements: GCC 10 or above with -fcoroutines, the drivers stay aggregates in C++17. otherwise this header is empty.
+///     spawn it from the scheduler task, or before the scheduler runs
+/// @example
+///     coro::Task poll(I2C& i2c, UART& uart) {
+///         uint8_t buf[6];
+///         for (;;) {
+///             if (co_await coro::read(i2c, {.deviceAddr=0xD0, .memAddr=0x3B, .buf=buf, .len=sizeof(buf)}, etl::time::milliseconds(10)) == HAL_OK)
+///                 co_await coro::transmit(uart, buf, sizeof(buf));
+///             co_await coro::sleep(etl::time::milliseconds(100));
+///         }
+///     }
+struct Project::periph::coro::Task {
+    struct promise_type {
+        static void* operator new(size_t size) noexcept {
+            if (size > largestFrame)
+                largestFrame = size;
+            return size > sizeof(Frame) ? nullptr : frames.allocate();
+        }
+
+        static void operator delete(void* frame) noexcept { frames.release(static_cast<Frame*>(frame)); }
+
+        static Task get_return_object_on_allocation_failure() { return {false}; }
+        Task get_return_object() { return {true}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+
+    bool started; ///< false if no frame was available
+
+    explicit operator bool() const { return started; }
+};
+
+/// base of the awaitables. an interrupt or the scheduler completes it with finish(), which queues the coroutine,
+/// the first to finish wins, so a completion racing a timeout is resolved without locks
+struct Project::periph::coro::Waiter {
+    enum : uint32_t { statePending, stateDone, stateTimeout };
+
+    std::coroutine_handle<> handle = {};
+    std::atomic<uint32_t> state = {statePending};
+    uint32_t start = 0;                     ///< HAL tick of the suspension
+    uint32_t timeout;                       ///< HAL milliseconds, etl::time::infinite to wait forever
+    bool (*poll)(Waiter*) = nullptr;        ///< optional condition checked by the scheduler until it returns true
+    void (*cancel)(Waiter*) = nullptr;      ///< optional, stops the operation after a timeout
+    Waiter* next = nullptr;                 ///< scheduler list of timed and polled waiters
+
+    explicit Waiter(etl::Time t = etl::time::infinite) : timeout(periph::detail::tickToMillis(t.tick)) {}
+
+    Waiter(const Waiter&) = delete;             ///< disable copy constructor
+    Waiter& operator=(const Waiter&) = delete;  ///< disable copy assignment
+
+    /// move the state from pending, may be called from interrupt context
+    /// @retval false if the wait has already been completed
+    bool claim(uint32_t how) {
+        uint32_t expected = statePending;
+        while (!periph::detail::ringCompareExchange(state, expected, how))
+            if (expected != statePending)
+                return false;
+        return true;
+    }
+
+    /// complete the wait and queue the coroutine, may be called from interrupt context
+    /// @retval false if the wait has already been completed
+    bool finish(uint32_t how = stateDone);
+
+    [[nodiscard]]
+    bool isTimeout() const { return state.load(std::memory_order_relaxed) == stateTimeout; }
+
+    /// scheduler bookkeeping, called by the awaitables from the scheduler task
+    void suspend(std::coroutine_handle<> h);
+    void resume();
+};
+
+/// runs the coroutines woken by interrupts and expires timeouts.
+/// interrupts push the handle into a lock-free ring, run() resumes them in order,
+/// so any number of protocol flows share the stack of one task
+/// @example
+///     coro::scheduler.notify = {+[] (void* thread) { osThreadFlagsSet(static_cast<osThreadId_t>(thread), 1); }, osThreadGetId()};
+///     for (;;) {
+///         uint32_t ticks = coro::scheduler.run();
+///         osThreadFlagsWait(1, osFlagsWaitAny, ticks);
+///     }
+struct Project::periph::coro::Scheduler {
+    using Notify = etl::Function<void(), void*>;
+
+    MpscRing<void*, PERIPH_CORO_READY_QUEUE_SIZE> ready = {};
+    Waiter* waiters = nullptr;      ///< timed and polled waiters, touched by the scheduler task only
+    Notify notify = {};             ///< invoked when a coroutine is queued, e.g. wake the scheduler task
+    volatile uint32_t dropped = 0;  ///< counts coroutines lost because the ready queue was full
+
+    Scheduler() = default;
+    Scheduler(const Scheduler&) = delete;               ///< disable copy constructor
+    Scheduler& operator=(const Scheduler&) = delete;    ///< disable copy assignment
+
+    /// queue a coroutine, may be called from interrupt context
+    bool post(std::coroutine_handle<> h) {
+        if (!ready.push(h.address())) {
+            dropped = dropped + 1;
+            return false;
+        }
+        notify();
+        return true;
+    }
+
+    /// expire timeouts, check polled waiters, and resume the queued coroutines
+    /// @retval kernel ticks until the next deadline, 0 if coroutines are queued, etl::time::infinite if nothing is timed
+    uint32_t run();
+
+    void add(Waiter* waiter) {
+        waiter->next = waiters;
+        waiters = waiter;
+    }
+
+    void remove(Waiter* waiter) {
+        for (Waiter** p = &waiters; *p != nullptr; p = &(*p)->next) if (*p == waiter) {
+            *p = waiter->next;
+            return;
+        }
+    }
+};
+
+inline bool Project::periph::coro::Waiter::finish(uint32_t how) {
+    if (!claim(how))
+        return false;
+    scheduler.post(handle);
+    return true;
+}
+
+inline void Project::periph::coro::Waiter::suspend(std::coroutine_handle<> h) {
+    handle = h;
+    start = HAL_GetTick();
+    if (poll || timeout != etl::time::infinite.tick)
+        scheduler.add(this);
+}
+
+inline void Project::periph::coro::Waiter::resume() {
+    if (poll || timeout != etl::time::infinite.tick)
+        scheduler.remove(this);
+}
+
+/// suspend for a duration
+struct Project::periph::coro::Sleep : Waiter {
+    explicit Sleep(etl::Time duration) : Waiter(duration) {}
+
+    bool await_ready() const noexcept { return timeout == 0; }
+    void await_suspend(std::coroutine_handle<> h) { suspend(h); }
+    void await_resume() { resume(); }
+};
+
+namespace Project::periph::coro {
+    [[nodiscard]]
+    inline Sleep sleep(etl::Time duration) { return Sleep(duration); }
+}
+
+#ifdef HAL_UART_MODULE_ENABLED
+/// transmit and wait for the tx complete interrupt
+/// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h), HAL_TIMEOUT if aborted
+struct Project::periph::coro::UartTransmit : Waiter {
+    UART& uart;
+    const void* buf;
+    size_t len;
+    int result = HAL_OK;
+
+    UartTransmit(UART& u, const void* b, size_t n, etl::Time t) : Waiter(t), uart(u), buf(b), len(n) {
+        cancel = +[] (Waiter* self) { HAL_UART_AbortTransmit(&static_cast<UartTransmit*>(self)->uart.huart); };
+    }
+
+    [[nodiscard]]
+    UART::TxCallback callback() { return {+[] (void* self) { static_cast<UartTransmit*>(self)->finish(); }, this}; }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        // attach only to an idle transmitter, a pending completion of another transfer would wake us early
+        if (uart.huart.gState != HAL_UART_STATE_READY) {
+            result = HAL_BUSY;
+            return false;
+        }
+
+        handle = h;
+        detail::critical([this] { uart.txCallbackList.push(callback()); });
+        result = uart.txCallbackList.find(callback()) ? uart.transmit(buf, len) : HAL_ERROR;
+        if (result == HAL_OK) {
+            suspend(h);
+            return true;
+        }
+
+        detail::critical([this] { uart.txCallbackList.pop(callback()); });
+        return false;
+    }
+
+    int await_resume() {
+        resume();
+        detail::critical([this] { uart.txCallbackList.pop(callback()); });
+        return isTimeout() ? HAL_TIMEOUT : result;
+    }
+};
+
+/// wait for the next received frame and copy it
+/// @retval number of bytes copied, 0 on timeout
+/// @note requirements: uart.init() called
+struct Project::periph::coro::UartReceive : Waiter {
+    UART& uart;
+    uint8_t* buf;
+    size_t len;
+
+    UartReceive(UART& u, uint8_t* b, size_t n, etl::Time t) : Waiter(t), uart(u), buf(b), len(n) {}
+
+    [[nodiscard]]
+    UART::RxCallback callback() {
+        return {+[] (void* ctx, const uint8_t* data, size_t size) {
+            auto self = static_cast<UartReceive*>(ctx);
+            if (self->state.load(std::memory_order_relaxed) != statePending)
+                return;
+
+            if (size > self->len)
+                size = self->len;
+            ::memcpy(self->buf, data, size);
+            self->len = size;
+            self->finish();
+        }, this};
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        handle = h;
+        detail::critical([this] { uart.rxCallbackList.push(callback()); });
+        if (uart.rxCallbackList.find(callback()) == nullptr) {
+            len = 0;
+            return false;
+        }
+        suspend(h);
+        return true;
+    }
+
+    size_t await_resume() {
+        resume();
+        detail::critical([this] { uart.rxCallbackList.pop(callback()); });
+        return isTimeout() ? 0 : len;
+    }
+};
+
+namespace Project::periph::coro {
+    /// @param uart UART instance
+    /// @param buf data, valid until the transfer completes
+    /// @param len data length
+    /// @param timeout abort the transfer after this, default etl::time::infinite
+    [[nodiscard]]
+    inline UartTransmit transmit(UART& uart, const void* buf, size_t len, etl::Time timeout = etl::time::infinite) {
+        return UartTransmit(uart, buf, len, timeout);
+    }
+
+    /// @param uart UART instance
+    /// @param buf[out] received data, the frame is truncated to len
+    /// @param len buffer length
+    /// @param timeout default etl::time::infinite
+    [[nodiscard]]
+    inline UartReceive receive(UART& uart, uint8_t* buf, size_t len, etl::Time timeout = etl::time::infinite) {
+        return UartReceive(uart, buf, len, timeout);
+    }
+}
+#endif // HAL_UART_MODULE_ENABLED
+
+#ifdef HAL_I2C_MODULE_ENABLED
+/// I2C memory read or write, waits for the complete or error interrupt.
+/// the callbacks of the instance are replaced during the transfer
+/// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h), HAL_TIMEOUT if the peripheral has been reinitialized after a timeout
+struct Project::periph::coro::I2cTransfer : Waiter {
+    I2C& i2c;
+    I2C::ReadWriteArgs args;
+    bool isRead;
+    int result = HAL_OK;
+    I2C::Callback txCallback = {}, rxCallback = {}, errorCallback = {}; ///< callbacks of the instance, restored afterwards
+
+    I2cTransfer(I2C& bus, I2C::ReadWriteArgs a, bool read, etl::Time t) : Waiter(t), i2c(bus), args(a), isRead(read) {
+        // stops the DMA and recovers the bus
+        cancel = +[] (Waiter* self) {
+            auto& hi2c = static_cast<I2cTransfer*>(self)->i2c.hi2c;
+            HAL_I2C_DeInit(&hi2c);
+            HAL_I2C_Init(&hi2c);
+        };
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        if (i2c.hi2c.State != HAL_I2C_STATE_READY) {
+            result = HAL_BUSY;
+            return false;
+        }
+
+        handle = h;
+        I2C::Callback done = {+[] (void* self) { static_cast<I2cTransfer*>(self)->finish(); }, this};
+        I2C::Callback error = {+[] (void* ctx) {
+            auto self = static_cast<I2cTransfer*>(ctx);
+            if (self->claim(stateDone)) {
+                self->result = HAL_ERROR;
+                scheduler.post(self->handle);
+            }
+        }, this};
+
+        detail::critical([&] {
+            txCallback = i2c.txCallback;
+            rxCallback = i2c.rxCallback;
+            errorCallback = i2c.errorCallback;
+            i2c.txCallback = done;
+            i2c.rxCallback = done;
+            i2c.errorCallback = error;
+        });
+
+        result = isRead ? i2c.read(args) : i2c.write(args);
+        if (result == HAL_OK) {
+            suspend(h);
+            return true;
+        }
+
+        restore();
+        return false;
+    }
+
+    int await_resume() {
+        resume();
+        restore();
+        return isTimeout() ? HAL_TIMEOUT : result;
+    }
+
+    void restore() {
+        detail::critical([this] {
+            i2c.txCallback = txCallback;
+            i2c.rxCallback = rxCallback;
+            i2c.errorCallback = errorCallback;
+        });
+    }
+};
+
+namespace Project::periph::coro {
+    /// @param i2c I2C instance
+    /// @param args see I2C::write()
+    /// @param timeout default etl::time::infinite
+    [[nodiscard]]
+    inline I2cTransfer write(I2C& i2c, I2C::ReadWriteArgs args, etl::Time timeout = etl::time::infinite) {
+        return I2cTransfer(i2c, args, false, timeout);
+    }
+
+    /// @param i2c I2C instance
+    /// @param args see I2C::read()
+    /// @param timeout default etl::time::infinite
+    [[nodiscard]]
+    inline I2cTransfer read(I2C& i2c, I2C::ReadWriteArgs args, etl::Time timeout = etl::time::infinite) {
+        return I2cTransfer(i2c, args, true, timeout);
+    }
+}
+#endif // HAL_I2C_MODULE_ENABLED
+
+#ifdef HAL_CAN_MODULE_ENABLED
+/// transmit as soon as a tx mailbox is free. the driver has no tx interrupt, the scheduler polls the mailboxes
+/// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h), HAL_TIMEOUT if no mailbox became free
+template <typename Args>
+struct Project::periph::coro::CanTransmit : Waiter {
+    CAN& can;
+    Args args;
+    int result = HAL_OK;
+
+    CanTransmit(CAN& c, Args a, etl::Time t) : Waiter(t), can(c), args(a) {
+        poll = +[] (Waiter* self) { return static_cast<CanTransmit*>(self)->isFree(); };
+    }
+
+    [[nodiscard]]
+    bool isFree() { return HAL_CAN_GetTxMailboxesFreeLevel(&can.hcan) > 0; }
+
+    bool await_ready() { return isFree(); }
+    void await_suspend(std::coroutine_handle<> h) { suspend(h); }
+
+    int await_resume() {
+        resume();
+        return isTimeout() ? HAL_TIMEOUT : can.transmit(args);
+    }
+};
+
+/// wait for the next received message
+/// @retval HAL_OK, HAL_TIMEOUT, or HAL_ERROR if the callback list is full
+struct Project::periph::coro::CanReceive : Waiter {
+    CAN& can;
+    CAN::Message& msg;
+    int result = HAL_OK;
+
+    CanReceive(CAN& c, CAN::Message& m, etl::Time t) : Waiter(t), can(c), msg(m) {}
+
+    [[nodiscard]]
+    CAN::Callback callback() {
+        return {+[] (void* ctx, CAN::Message& received) {
+            auto self = static_cast<CanReceive*>(ctx);
+            if (self->state.load(std::memory_order_relaxed) != statePending)
+                return;
+
+            self->msg = received;
+            self->finish();
+        }, this};
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        handle = h;
+        detail::critical([this] { can.rxCallbackList.push(callback()); });
+        if (can.rxCallbackList.find(callback()) == nullptr) {
+            result = HAL_ERROR;
+            return false;
+        }
+        suspend(h);
+        return true;
+    }
+
+    int await_resume() {
+        resume();
+        detail::critical([this] { can.rxCallbackList.pop(callback()); });
+        return isTimeout() ? HAL_TIMEOUT : result;
+    }
+};
+
+namespace Project::periph::coro {
+    /// @param can CAN instance
+    /// @param args any argument of CAN::transmit(), e.g. CAN::TransmitIdTxArgs
+    /// @param timeout default etl::time::infinite
+    template <typename Args>
+    [[nodiscard]]
+    CanTransmit<Args> transmit(CAN& can, Args args, etl::Time timeout = etl::time::infinite) {
+        return CanTransmit<Args>(can, args, timeout);
+    }
+
+    /// @param can CAN instance
+    /// @param msg[out] received message
+    /// @param timeout default etl::time::infinite
+    [[nodiscard]]
+    inline CanReceive receive(CAN& can, CAN::Message& msg, etl::Time timeout = etl::time::infinite) {
+        return CanReceive(can, msg, timeout);
+    }
+}
+#endif // HAL_CAN_MODULE_ENABLED
+
+#ifdef HAL_I2S_MODULE_ENABLED
+/// wait for the next half of the DMA buffers, one waiter per instance
+/// @retval I2S::FLAG_HALF or I2S::FLAG_FULL, the half of rxBuffer just received and of txBuffer to refill, 0 on timeout
+struct Project::periph::coro::I2sBlock : Waiter {
+    I2S& i2s;
+    int flag = 0;
+
+    I2sBlock(I2S& s, etl::Time t) : Waiter(t), i2s(s) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        handle = h;
+        detail::critical([this] {
+            i2s.blockCallback = {+[] (void* ctx, int fl) {
+                auto self = static_cast<I2sBlock*>(ctx);
+                if (self->claim(stateDone)) {
+                    self->flag = fl;
+                    scheduler.post(self->handle);
+                }
+            }, this};
+        });
+        suspend(h);
+    }
+
+    int await_resume() {
+        resume();
+        detail::critical([this] { i2s.blockCallback = {}; });
+        return flag;
+    }
+};
+
+namespace Project::periph::coro {
+    /// @param i2s I2S instance
+    /// @param timeout default twice the block duration, I2S::eventTimeout
+    [[nodiscard]]
+    inline I2sBlock block(I2S& i2s, etl::Time timeout = I2S::eventTimeout) { return I2sBlock(i2s, timeout); }
+}
+#endif // HAL_I2S_MODULE_ENABLED
+
+#endif // __cpp_impl_coroutine
+#endif // PERIPH_COROUTINE_H
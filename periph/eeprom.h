@@ -0,0 +1,242 @@
+#ifndef PERIPH_EEPROM_H
+#define PERIPH_EEPROM_H
+
+#include "main.h"
+#ifdef HAL_I2C_MODULE_ENABLED
+
+#include "periph/i2c.h"
+
+namespace Project::periph { struct EEPROM; }
+
+/// I2C EEPROM/FRAM block device.
+/// writes are split along page boundaries, the write cycle of a page is awaited with acknowledge polling
+/// right before the next transfer, so the caller is not blocked by the write cycle of the last page.
+/// write() chains the pages from the I2C interrupts: the next page is sent as soon as the previous one is out,
+/// the device NACKs its address while the write cycle runs and the page is resent until it is acknowledged
+/// @note requirements: I2C event and error interrupt, I2C rx DMA for non blocking read
+struct Project::periph::EEPROM {
+    using DoneCallback = etl::Function<void(int), void*>;   ///< takes the HAL_StatusTypeDef of the whole write
+
+    I2C& i2c;                                       ///< I2C bus
+    uint16_t deviceAddr;                            ///< device address
+    uint16_t pageSize = 0;                          ///< write page size in bytes, 0 for FRAM (no page and no write cycle)
+    uint16_t memAddrSize = I2C_MEMADD_SIZE_16BIT;   ///< I2C_MEMADD_SIZE_8BIT or I2C_MEMADD_SIZE_16BIT
+    etl::Time writeCycleTimeout = etl::time::milliseconds(10); ///< maximum page write cycle time
+    bool writeInProgress = false;                   ///< a page write cycle may still be running
+    volatile bool isWriting = false;                ///< a non blocking write() is in progress
+
+    EEPROM(const EEPROM&) = delete;             ///< disable copy constructor
+    EEPROM& operator=(const EEPROM&) = delete;  ///< disable copy assignment
+
+    /// wait until the device acknowledges its address, i.e. the last write cycle is finished.
+    /// waiting for the bus and for the write cycle share the deadline of writeCycleTimeout
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h), HAL_BUSY while a non blocking write() runs
+    int waitReady() {
+        if (isWriting)
+            return HAL_BUSY;
+        if (!writeInProgress)
+            return HAL_OK;
+
+        uint32_t start = HAL_GetTick();
+        uint32_t timeout = detail::tickToMillis(writeCycleTimeout.tick);
+        while (i2c.hi2c.State != HAL_I2C_STATE_READY) {
+            if (HAL_GetTick() - start > timeout)
+                return HAL_TIMEOUT;
+        }
+
+        do {
+            if (HAL_I2C_IsDeviceReady(&i2c.hi2c, deviceAddr, 1, 1) == HAL_OK) {
+                writeInProgress = false;
+                return HAL_OK;
+            }
+        } while (HAL_GetTick() - start <= timeout);
+
+        return HAL_TIMEOUT;
+    }
+
+    struct ReadWriteBlockingArgs { uint32_t memAddr; const uint8_t* buf; size_t len; etl::Time timeout = etl::time::infinite; };
+
+    /// write blocking, split along page boundaries
+    /// @param args
+    ///     - .memAddr memory address
+    ///     - .buf pointer to data buffer
+    ///     - .len data length
+    ///     - .timeout timeout of each page transfer, default time::infinite
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
+    int writeBlocking(ReadWriteBlockingArgs args) {
+        while (args.len > 0) {
+            size_t chunk = chunkSize(args.memAddr, args.len, pageSize);
+
+            int res = waitReady();
+            if (res != HAL_OK)
+                return res;
+
+            res = HAL_I2C_Mem_Write(&i2c.hi2c, address(args.memAddr), uint16_t(args.memAddr), memAddrSize,
+                                    const_cast<uint8_t*>(args.buf), uint16_t(chunk), detail::tickToMillis(args.timeout.tick));
+            if (res != HAL_OK)
+                return res;
+
+            writeInProgress = pageSize > 0;
+            args.memAddr += chunk;
+            args.buf += chunk;
+            args.len -= chunk;
+        }
+
+        return HAL_OK;
+    }
+
+    /// read blocking, one transfer per address block
+    /// @param args
+    ///     - .memAddr memory address
+    ///     - .buf[out] pointer to data buffer
+    ///     - .len data length
+    ///     - .timeout timeout of each transfer, default time::infinite
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
+    int readBlocking(ReadWriteBlockingArgs args) {
+        while (args.len > 0) {
+            size_t chunk = chunkSize(args.memAddr, args.len, 0);
+
+            int res = waitReady();
+            if (res != HAL_OK)
+                return res;
+
+            res = HAL_I2C_Mem_Read(&i2c.hi2c, address(args.memAddr), uint16_t(args.memAddr), memAddrSize,
+                                   const_cast<uint8_t*>(args.buf), uint16_t(chunk), detail::tickToMillis(args.timeout.tick));
+            if (res != HAL_OK)
+                return res;
+
+            args.memAddr += chunk;
+            args.buf += chunk;
+            args.len -= chunk;
+        }
+
+        return HAL_OK;
+    }
+
+    struct WriteArgs { uint32_t memAddr; const uint8_t* buf; size_t len; DoneCallback doneCallback = {}; };
+
+    /// write non blocking, split along page boundaries and chained from the I2C interrupts.
+    /// i2c.txCallback and i2c.errorCallback are taken over until the write is done and restored before doneCallback
+    /// @param args
+    ///     - .memAddr memory address
+    ///     - .buf pointer to data buffer, valid until doneCallback
+    ///     - .len data length
+    ///     - .doneCallback invoked from the interrupt with HAL_OK, HAL_TIMEOUT if a write cycle outlasted
+    ///       writeCycleTimeout, or the HAL status of the failed page
+    /// @retval HAL_StatusTypeDef of the first page transfer, HAL_BUSY if a write is in progress
+    int write(WriteArgs args) {
+        if (isWriting)
+            return HAL_BUSY;
+
+        pending = args;
+        savedTxCallback = i2c.txCallback;
+        savedErrorCallback = i2c.errorCallback;
+        i2c.txCallback = {+[] (void* self) { static_cast<EEPROM*>(self)->pageSent(); }, this};
+        i2c.errorCallback = {+[] (void* self) { static_cast<EEPROM*>(self)->pageFailed(); }, this};
+        isWriting = true;
+        pollStart = HAL_GetTick();
+
+        if (args.len == 0) {
+            finish(HAL_OK);
+            return HAL_OK;
+        }
+
+        int res = sendPage();
+        if (res != HAL_OK)
+            release();
+        return res;
+    }
+
+    struct ReadArgs { uint32_t memAddr; uint8_t* buf; size_t len; };
+
+    /// read non blocking in a single DMA transfer, i2c.rxCallback is invoked when the transfer is complete
+    /// @param args
+    ///     - .memAddr memory address
+    ///     - .buf[out] pointer to data buffer
+    ///     - .len data length, the region must not cross an address block
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
+    int read(ReadArgs args) {
+        if (chunkSize(args.memAddr, args.len, 0) != args.len)
+            return HAL_ERROR;
+
+        int res = waitReady();
+        if (res != HAL_OK)
+            return res;
+
+        return HAL_I2C_Mem_Read_DMA(&i2c.hi2c, address(args.memAddr), uint16_t(args.memAddr), memAddrSize, args.buf, uint16_t(args.len));
+    }
+
+private:
+    WriteArgs pending = {};
+    I2C::Callback savedTxCallback = {};
+    I2C::Callback savedErrorCallback = {};
+    uint32_t pollStart = 0;                 ///< HAL tick of the end of the last page, or of write()
+
+    int sendPage() {
+        auto chunk = uint16_t(chunkSize(pending.memAddr, pending.len, pageSize));
+        return i2c.write({ .deviceAddr=address(pending.memAddr), .memAddr=uint16_t(pending.memAddr),
+                           .buf=pending.buf, .len=chunk, .memAddrSize=memAddrSize });
+    }
+
+    /// a page is out, its write cycle starts, send the next one
+    void pageSent() {
+        size_t chunk = chunkSize(pending.memAddr, pending.len, pageSize);
+        pending.memAddr += chunk;
+        pending.buf += chunk;
+        pending.len -= chunk;
+        writeInProgress = pageSize > 0;
+
+        if (pending.len == 0)
+            return finish(HAL_OK);
+
+        pollStart = HAL_GetTick();
+        int res = sendPage();
+        if (res != HAL_OK)
+            finish(res);
+    }
+
+    /// the device NACKs its address during the write cycle, resend the page until it is acknowledged
+    void pageFailed() {
+        bool nack = (i2c.hi2c.ErrorCode & HAL_I2C_ERROR_AF) != 0;
+        if (!nack || !writeInProgress)
+            return finish(HAL_ERROR);
+        if (HAL_GetTick() - pollStart > detail::tickToMillis(writeCycleTimeout.tick))
+            return finish(HAL_TIMEOUT);
+
+        int res = sendPage();
+        if (res != HAL_OK)
+            finish(res);
+    }
+
+    void release() {
+        i2c.txCallback = savedTxCallback;
+        i2c.errorCallback = savedErrorCallback;
+        isWriting = false;
+    }
+
+    void finish(int status) {
+        auto done = pending.doneCallback;
+        release();
+        done(status);
+    }
+
+    /// number of memory address bits carried by the memory address bytes
+    uint32_t addressBits() const { return memAddrSize == I2C_MEMADD_SIZE_8BIT ? 8 : 16; }
+
+    /// memory address bits above the memory address bytes are carried by the device address (block select)
+    uint16_t address(uint32_t memAddr) const { return deviceAddr | uint16_t((memAddr >> addressBits()) << 1); }
+
+    /// largest transfer starting at memAddr that doesn't cross a page, an address block, or the HAL length limit
+    size_t chunkSize(uint32_t memAddr, size_t len, uint32_t page) const {
+        uint32_t block = 1ul << addressBits();
+        size_t res = block - (memAddr & (block - 1));
+        if (page > 0 && page - (memAddr % page) < res)
+            res = page - (memAddr % page);
+        if (res > 0xFFFF)
+            res = 0xFFFF;
+        return len < res ? len : res;
+    }
+};
+
+#endif // HAL_I2C_MODULE_ENABLED
+#endif // PERIPH_EEPROM_H
@@ -5,22 +5,36 @@
 #ifdef HAL_TIM_MODULE_ENABLED
 
 #include "periph/config.h"
+#include "periph/tim_router.h"
 #include "Core/Inc/tim.h"
 #include "etl/function.h"
 
 namespace Project::periph {
 
     /// rotary encoder using TIM
-    /// @note requirements: TIMx encoder mode, TIMx global interrupt
+    /// @note requirements: TIMx encoder mode, TIMx global interrupt (not needed with PERIPH_ENCODER_USE_POLLING)
     struct Encoder {
         using Callback = etl::Function<void(), void*>;
         inline static detail::UniqueInstances<Encoder*, 16> Instances;
 
+        enum { velocityM, velocityPLL };
+
         TIM_HandleTypeDef &htim;            ///< TIM handler configured by cubeMX
         int16_t value = 0;                  ///< current value
         Callback incrementCallback = {};    ///< increment callback
         Callback decrementCallback = {};    ///< decrement callback
 
+        int64_t position = 0;               ///< accumulated position in counts (4 counts per detent), kept across counter overflow
+        float velocity = 0;                 ///< estimated velocity in counts per second, updated by sample()
+        int velocityMethod = velocityM;     ///< velocityM: counts per sample period, velocityPLL: tracking observer
+        float samplePeriod = 0.001f;        ///< sample() period in seconds
+        float pllBandwidth = 200.0f;        ///< observer bandwidth in rad/s, critically damped
+
+        uint32_t lastCounter = 0;
+        int64_t samplePosition = 0;         ///< position at the last sample()
+        int64_t pllPosition = 0;
+        float pllFraction = 0;
+
         Encoder(const Encoder&) = delete;             ///< disable copy constructor
         Encoder& operator=(const Encoder&) = delete;  ///< disable copy assignment
 
@@ -36,6 +50,17 @@ namespace Project::periph {
             #ifdef PERIPH_ENCODER_USE_DMA
             HAL_TIM_Encoder_Start_DMA(&htim, TIM_CHANNEL_ALL, dmaBufferA, dmaBufferB, len); 
             #endif
+            #ifdef PERIPH_ENCODER_USE_POLLING
+            HAL_TIM_Encoder_Start(&htim, TIM_CHANNEL_ALL);
+            #endif
+            lastCounter = htim.Instance->CNT;
+            samplePosition = position;
+            pllPosition = position;
+            pllFraction = 0;
+            velocity = 0;
+            TimRouter::Callback callback = {+[] (void* self) { static_cast<Encoder*>(self)->inputCaptureCallback(); }, this};
+            TimRouter::attach(htim, TimRouter::eventCapture, TIM_CHANNEL_1, callback);
+            TimRouter::attach(htim, TimRouter::eventCapture, TIM_CHANNEL_2, callback);
             Instances.push(this);
         }
 
@@ -47,16 +72,71 @@ namespace Project::periph {
             #ifdef PERIPH_ENCODER_USE_DMA
             HAL_TIM_Encoder_Stop_DMA(&htim, TIM_CHANNEL_ALL); 
             #endif
+            #ifdef PERIPH_ENCODER_USE_POLLING
+            HAL_TIM_Encoder_Stop(&htim, TIM_CHANNEL_ALL);
+            #endif
+            TimRouter::detach(htim, TimRouter::eventCapture, TIM_CHANNEL_1);
+            TimRouter::detach(htim, TimRouter::eventCapture, TIM_CHANNEL_2);
             Instances.pop(this);
         }
 
         void inputCaptureCallback() {
-            uint16_t counter = htim.Instance->CNT;
-            int cnt = counter / 4;
+            uint32_t counter;
+            accumulate(counter);
+            int cnt = uint16_t(counter) / 4;
             if (cnt > value) incrementCallback();
             if (cnt < value) decrementCallback();
             value = static_cast<int16_t> (cnt);
         }
+
+        /// update position and velocity, call it at a fixed rate of 1 / samplePeriod,
+        /// e.g. from a timer period elapsed interrupt
+        void sample() {
+            uint32_t counter;
+            int64_t now = accumulate(counter);
+
+            #ifdef PERIPH_ENCODER_USE_POLLING
+            int cnt = uint16_t(counter) / 4;
+            if (cnt > value) incrementCallback();
+            if (cnt < value) decrementCallback();
+            value = static_cast<int16_t> (cnt);
+            #endif
+
+            if (velocityMethod == velocityPLL) {
+                float kp = 2.0f * pllBandwidth;
+                float ki = pllBandwidth * pllBandwidth;
+                float error = float(now - pllPosition) - pllFraction;
+
+                pllFraction += (velocity + kp * error) * samplePeriod;
+                velocity += ki * error * samplePeriod;
+
+                auto whole = int64_t(pllFraction);
+                pllPosition += whole;
+                pllFraction -= float(whole);
+            } else {
+                velocity = float(now - samplePosition) / samplePeriod;
+            }
+            samplePosition = now;
+        }
+
+    private:
+        /// add the counter change since the last call to position, the change is taken modulo ARR + 1.
+        /// CNT is read in the critical section, so a sample() preempting an input capture callback
+        /// can not make it accumulate a counter older than lastCounter
+        /// @param counter[out] the CNT value accumulated
+        /// @retval the new position, read in the same critical section so the 64-bit value is never torn
+        int64_t accumulate(uint32_t& counter) {
+            uint64_t modulus = uint64_t(htim.Instance->ARR) + 1;
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            counter = htim.Instance->CNT;
+            uint64_t delta = (uint64_t(counter) + modulus - lastCounter) % modulus;
+            position += delta > modulus / 2 ? int64_t(delta) - int64_t(modulus) : int64_t(delta);
+            lastCounter = counter;
+            int64_t res = position;
+            __set_PRIMASK(primask);
+            return res;
+        }
     };
 } // periph
 
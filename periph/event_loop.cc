@@ -0,0 +1,99 @@
+#include "periph/event_loop.h"
+
+#ifdef PERIPH_USE_BARE_METAL
+
+#include "periph/work_queue.h"
+#include "periph/exti.h"
+#include "periph/coroutine.h"
+
+using namespace Project::periph;
+
+WorkQueue* EventLoop::queues[PERIPH_EVENT_LOOP_MAX_QUEUES];
+detail::UniqueInstances<EventLoop::Timer*, PERIPH_EVENT_LOOP_MAX_TIMERS> EventLoop::Timers;
+
+void EventLoop::attach(WorkQueue* queue) {
+    constexpr size_t n = PERIPH_EVENT_LOOP_MAX_QUEUES;
+    for (auto q : queues) if (q == queue)
+        return;
+
+    // keep the table sorted by descending priority, a queue that does not fit is never run
+    if (queues[n - 1] != nullptr)
+        return;
+
+    size_t i = 0;
+    while (queues[i] != nullptr && queues[i]->priority >= queue->priority)
+        ++i;
+
+    for (size_t j = n - 1; j > i; --j)
+        queues[j] = queues[j - 1];
+    queues[i] = queue;
+}
+
+size_t EventLoop::runOnce() {
+    size_t n = 0;
+    for (auto queue : queues) if (queue != nullptr)
+        n += queue->process();
+
+    #ifdef HAL_EXTI_MODULE_ENABLED
+    n += Exti::process();
+    #endif
+
+    uint32_t now = HAL_GetTick();
+    for (auto timer : Timers.instances) {
+        if (timer == nullptr)
+            continue;
+
+        // the interval is in kernel ticks, base and now in HAL milliseconds
+        uint32_t interval = detail::tickToMillis(timer->interval.tick);
+        if (now - timer->base < interval)
+            continue;
+
+        if (timer->periodic)
+            timer->base += interval;
+        else
+            timer->stop();
+
+        timer->callback();
+        n++;
+    }
+
+    #ifdef PERIPH_USE_COROUTINE
+    size_t queued = coro::scheduler.ready.size();
+    coro::scheduler.run();
+    n += queued;
+    #endif
+
+    return n;
+}
+
+bool EventLoop::isPending() {
+    for (auto queue : queues) if (queue != nullptr && queue->items.size() > 0)
+        return true;
+
+    #ifdef HAL_EXTI_MODULE_ENABLED
+    if (Exti::isPending())
+        return true;
+    #endif
+
+    #ifdef PERIPH_USE_COROUTINE
+    if (coro::scheduler.ready.size() > 0)
+        return true;
+    #endif
+
+    return false;
+}
+
+void EventLoop::run() {
+    for (;;) {
+        if (runOnce() > 0)
+            continue;
+
+        // an interrupt taken after the check stays pending and wakes WFI even with interrupts masked
+        __disable_irq();
+        if (!isPending())
+            __WFI();
+        __enable_irq();
+    }
+}
+
+#endif // PERIPH_USE_BARE_METAL
@@ -0,0 +1,92 @@
+#ifndef PERIPH_EVENT_LOOP_H
+#define PERIPH_EVENT_LOOP_H
+
+#include "main.h"
+#include "periph/config.h"
+#ifdef PERIPH_USE_BARE_METAL
+
+#include "etl/function.h"
+#include "etl/time.h"
+
+namespace Project::periph {
+    struct WorkQueue;
+    struct EventLoop;
+}
+
+/// run-to-completion executor for the builds without an RTOS, everything runs on the main stack.
+/// interrupts post work and events, run() dispatches them in this order:
+///     - work queues, higher priority first (see periph/work_queue.h)
+///     - deferred EXTI events (see Exti::process())
+///     - expired timers
+///     - coroutines woken by the drivers (see periph/coroutine.h)
+/// then sleeps with WFI until the next interrupt. timers count HAL milliseconds, their interval is converted from etl::Time ticks,
+/// the HAL timebase (SysTick or PERIPH_SYSTICK_TIM_BASE_SOURCE) is the only hardware timer used.
+/// with PERIPH_USE_TRACE, trace::sourceWorkQueue gives the dispatch latency to compare with the RTOS build
+/// @note requirements: PERIPH_USE_BARE_METAL
+/// @example
+///     EventLoop::Timer blink = { .interval=etl::time::milliseconds(500), .callback={+[] (void* led) {
+///         static_cast<GPIO*>(led)->toggle();
+///     }, &led}, .periodic=true };
+///
+///     int main() {
+///         ...
+///         queue.init();
+///         blink.start();
+///         EventLoop::run();
+///     }
+struct Project::periph::EventLoop {
+    struct Timer;
+
+    static WorkQueue* queues[PERIPH_EVENT_LOOP_MAX_QUEUES];     ///< higher priority first
+    static detail::UniqueInstances<Timer*, PERIPH_EVENT_LOOP_MAX_TIMERS> Timers;    ///< running timers
+
+    /// add a work queue, called by WorkQueue::init()
+    static void attach(WorkQueue* queue);
+
+    /// dispatch everything pending once
+    /// @retval number of work items, events, timers and coroutines run
+    static size_t runOnce();
+
+    /// true if an interrupt has posted something runOnce() has not dispatched yet
+    [[nodiscard]]
+    static bool isPending();
+
+    /// dispatch forever, sleep while there is nothing to do
+    [[noreturn]]
+    static void run();
+};
+
+/// software timer fired by the event loop, start() and stop() may be called from interrupt context
+struct Project::periph::EventLoop::Timer {
+    using Callback = etl::Function<void(), void*>;
+
+    etl::Time interval;         ///< kernel ticks (see PERIPH_TICK_RATE_HZ) from start() to the callback
+    Callback callback;          ///< invoked by the event loop
+    bool periodic = false;      ///< restart after each callback
+    uint32_t base = 0;          ///< HAL tick in ms of start() or of the last period
+
+    Timer(const Timer&) = delete;               ///< disable copy constructor
+    Timer& operator=(const Timer&) = delete;    ///< disable copy assignment
+
+    /// (re)start counting from now
+    void start() {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        base = HAL_GetTick();
+        Timers.push(this);
+        __set_PRIMASK(primask);
+    }
+
+    void stop() {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        Timers.pop(this);
+        __set_PRIMASK(primask);
+    }
+
+    [[nodiscard]]
+    bool isRunning() { return Timers.find(this) != nullptr; }
+};
+
+#endif // PERIPH_USE_BARE_METAL
+#endif // PERIPH_EVENT_LOOP_H
@@ -1,38 +1,132 @@
 #include "periph/exti.h"
-#include "etl/bit.h"
-#include "cmsis_os2.h" // osKernelGetTickCount
-#include "main.h"
+#include "periph/ring.h"
+#include "periph/trace.h"
+
+#ifdef HAL_EXTI_MODULE_ENABLED
 
 using namespace Project;
 using namespace Project::periph;
 
 detail::UniqueInstances<Exti*, 16> Exti::Instances;
 
-extern "C" void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
-    uint16_t static pinNow;
-    etl::Time static timeNow;
+static_assert(PERIPH_EXTI_MAX_CALLBACKS_PER_LINE <= 16, "Event::accepted holds one bit per instance of a line");
+
+namespace {
+    struct Line {
+        detail::UniqueInstances<Exti*, PERIPH_EXTI_MAX_CALLBACKS_PER_LINE> instances;
+        uint32_t lastTick;  ///< HAL tick in ms of the last edge, triggered or filtered
+        bool hasEdge;       ///< false until the first edge
+    };
+}
+
+static Line lines[16];
 
-    auto pinPrev = pinNow;
-    auto timePrev = timeNow;
+static MpscRing<Exti::Event, PERIPH_EXTI_EVENT_RING_SIZE> events;
 
-    // don't proceed if the kernel is not running
-    if (osKernelGetState() != osKernelRunning)
+volatile uint32_t Exti::eventsDropped;
+volatile uint32_t Exti::eventsHighWater;
+
+static uint32_t timestamp() {
+    #ifdef DWT
+    return DWT->CYCCNT;
+    #else
+    return HAL_GetTick();
+    #endif
+}
+
+static void record(uint32_t line, uint8_t level, uint16_t accepted, uint32_t time) {
+    if (!events.emplace([=] (Exti::Event& event) { event = { uint8_t(line), level, accepted, time }; })) {
+        Exti::eventsDropped = Exti::eventsDropped + 1;
         return;
-        
-    timeNow = etl::time::now();
-    pinNow = GPIO_Pin;
-
-    for (auto instance : Exti::Instances.instances) {
-        if (instance == nullptr)
-            continue; // skip if instance is null
-        
-        if (!(pinNow & instance->pin))
-            continue; // skip if the triggered pin is not instance pin
-        
-        if (pinNow != pinPrev || etl::time::elapsed(timePrev) > instance->debounceDelay) {
+    }
+
+    uint32_t used = events.size();
+    if (used > Exti::eventsHighWater)
+        Exti::eventsHighWater = used;
+}
+
+void Exti::attach(Exti* exti) {
+    #ifdef DWT
+    if (exti->eventCallback) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    #endif
+
+    for (uint32_t i = 0; i < 16; ++i) if (exti->pin & (1u << i))
+        lines[i].instances.push(exti);
+}
+
+void Exti::detach(Exti* exti) {
+    for (auto& line : lines)
+        line.instances.pop(exti);
+}
+
+size_t Exti::poll(Event* dest, size_t n) {
+    return events.pop(dest, n);
+}
+
+bool Exti::isPending() {
+    return events.size() > 0;
+}
+
+size_t Exti::process() {
+    Event batch[8];
+    size_t total = 0;
+
+    for (size_t n = poll(batch, 8); n > 0; n = poll(batch, 8)) {
+        for (size_t i = 0; i < n; ++i) {
+            auto& instances = lines[batch[i].line].instances.instances;
+            for (uint32_t accepted = batch[i].accepted; accepted != 0; accepted &= accepted - 1) {
+                auto instance = instances[__builtin_ctz(accepted)];
+                if (instance != nullptr)
+                    instance->eventCallback(batch[i]);
+            }
+        }
+        total += n;
+    }
+
+    return total;
+}
+
+extern "C" void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    PERIPH_TRACE(trace::sourceExti);
+    uint32_t time = timestamp();
+    uint32_t now = HAL_GetTick();
+
+    for (uint32_t pins = GPIO_Pin; pins != 0; pins &= pins - 1) {
+        uint32_t index = __builtin_ctz(pins);
+        auto& line = lines[index];
+        uint32_t elapsed = now - line.lastTick;
+        bool first = !line.hasEdge;
+        uint16_t accepted = 0;
+        uint8_t level = 0xFF;
+
+        line.lastTick = now;
+        line.hasEdge = true;
+
+        for (uint32_t i = 0; i < PERIPH_EXTI_MAX_CALLBACKS_PER_LINE; ++i) {
+            auto instance = line.instances.instances[i];
+            if (instance == nullptr)
+                continue;
+
+            if (!first && elapsed <= detail::tickToMillis(instance->debounceDelay.tick))
+                continue;
+
             instance->counter++;
-            instance->callback();
-            return;
+            if (!instance->eventCallback) {
+                PERIPH_TRACE(trace::sourceExtiUser);
+                instance->callback();
+            } else {
+                if (accepted == 0 && instance->port)
+                    level = uint8_t((instance->port->IDR >> index) & 1);
+                accepted |= uint16_t(1u << i);
+            }
         }
+
+        if (accepted != 0)
+            record(index, level, accepted, time);
     }
 }
+
+#endif // HAL_EXTI_MODULE_ENABLED
@@ -13,20 +13,35 @@ namespace Project::periph { struct Exti; }
 /// external interrupt class
 /// @note requirements: configured external interrupt by CubeMX
 struct Project::periph::Exti {
+    /// edge record of a deferred instance
+    struct Event {
+        uint8_t line;       ///< EXTI line, 0..15
+        uint8_t level;      ///< pin level after the edge, 0xFF if port is not set
+        uint16_t accepted;  ///< bit i is set if the instance at position i of the line passed its debounce filter
+        uint32_t timestamp; ///< DWT cycle counter at the interrupt entry
+    };
+
     using Callback = etl::Function<void(), void*>;
+    using EventCallback = etl::Function<void(const Event&), void*>;
     static constexpr etl::Time debounceDelayDefault = etl::time::milliseconds(250);
     static detail::UniqueInstances<Exti*, 16> Instances;
 
+    static volatile uint32_t eventsDropped;         ///< counts events lost because the event ring was full
+    static volatile uint32_t eventsHighWater;       ///< maximum number of events waiting in the event ring
+
     uint16_t pin;                                    ///< GPIO_PIN_x
     Callback callback = {};                          ///< callback functions for the pin
-    etl::Time debounceDelay = debounceDelayDefault;  ///< debounce delay filter
+    etl::Time debounceDelay = debounceDelayDefault;  ///< debounce delay filter, in kernel ticks (see PERIPH_TICK_RATE_HZ)
     uint32_t counter = 0;                            ///< counts how many times the pin has been triggered
+    GPIO_TypeDef* port = nullptr;                    ///< GPIOx, to record the pin level of events
+    EventCallback eventCallback = {};                ///< deferred callback, invoked by process() instead of in the interrupt
 
     Exti(const Exti&) = delete;             ///< disable copy constructor
     Exti& operator=(const Exti&) = delete;  ///< disable copy assignment
 
-    // register this instance
+    // register this instance to the dispatch table of its lines
     void init() { 
+        attach(this);
         Instances.push(this); 
     }
 
@@ -39,8 +54,28 @@ struct Project::periph::Exti {
     // unregister this instance
     void deinit() { 
         callback = Callback();
+        detach(this);
         Instances.pop(this);
     }
+
+    /// pop recorded events
+    /// @param events[out] event buffer
+    /// @param n maximum number of events
+    /// @retval number of events popped
+    static size_t poll(Event* events, size_t n);
+
+    /// true if recorded events are waiting for process()
+    [[nodiscard]]
+    static bool isPending();
+
+    /// pop all recorded events in batches and invoke eventCallback of the instances of each event line
+    /// that accepted the edge, an instance whose debounce filter rejected it is skipped. call it from a task
+    /// @retval number of events processed
+    static size_t process();
+
+private:
+    static void attach(Exti* exti);
+    static void detach(Exti* exti);
 };
 
 #endif // HAL_EXTI_MODULE_ENABLED
@@ -0,0 +1,79 @@
+#ifndef PERIPH_FOC_H
+#define PERIPH_FOC_H
+
+#include <cstdint>
+
+/// fixed point field oriented control kernel.
+/// values are Q15 (32767 = 1.0), angles are uint16_t (65536 = one electrical turn)
+namespace Project::periph::foc {
+    struct AlphaBeta { int32_t alpha, beta; };
+    struct DQ { int32_t d, q; };
+    struct SinCos { int32_t sin, cos; };
+    struct ABC { int32_t a, b, c; };
+
+    inline int32_t saturate(int32_t value) {
+        return value > 32767 ? 32767 : value < -32767 ? -32767 : value;
+    }
+
+    /// 5th order polynomial sine, max error 15 LSB
+    inline int32_t sin(uint16_t angle) {
+        int32_t t = int16_t(angle);
+        if (t > 16384) t = 32768 - t;
+        else if (t < -16384) t = -32768 - t;
+
+        int32_t z = t * 2;
+        int32_t z2 = (z * z) >> 15;
+        int32_t r = 2320;                   // pi/2 - 3/2
+        r = -21024 + ((z2 * r) >> 15);      // 5/2 - pi
+        r = 51472 + ((z2 * r) >> 15);       // pi/2
+        return saturate((z * r) >> 15);
+    }
+
+    inline SinCos sinCos(uint16_t angle) {
+        return { sin(angle), sin(uint16_t(angle + 16384)) };
+    }
+
+    /// phase currents a, b (c = -a - b) to stationary frame
+    inline AlphaBeta clarke(int32_t a, int32_t b) {
+        return { a, saturate(((a + 2 * b) * 18919) >> 15) }; // 1/sqrt(3)
+    }
+
+    /// stationary frame to rotating frame
+    inline DQ park(AlphaBeta ab, SinCos sc) {
+        return {
+            saturate((ab.alpha * sc.cos + ab.beta * sc.sin) >> 15),
+            saturate((ab.beta * sc.cos - ab.alpha * sc.sin) >> 15),
+        };
+    }
+
+    /// rotating frame to stationary frame
+    inline AlphaBeta inversePark(DQ dq, SinCos sc) {
+        return {
+            saturate((dq.d * sc.cos - dq.q * sc.sin) >> 15),
+            saturate((dq.d * sc.sin + dq.q * sc.cos) >> 15),
+        };
+    }
+
+    /// space vector modulation by min-max zero sequence injection
+    /// @param v voltage vector normalized to the DC bus voltage, linear up to 1/sqrt(3)
+    /// @param period TIMx->ARR of a center aligned timer
+    /// @retval compare values of phase a, b, c
+    inline ABC svpwm(AlphaBeta v, uint32_t period) {
+        int32_t half = -v.alpha / 2;
+        int32_t beta = (v.beta * 28378) >> 15; // sqrt(3)/2
+        int32_t a = v.alpha, b = half + beta, c = half - beta;
+
+        int32_t max = a > b ? (a > c ? a : c) : (b > c ? b : c);
+        int32_t min = a < b ? (a < c ? a : c) : (b < c ? b : c);
+        int32_t offset = 16384 - (max + min) / 2;
+
+        auto duty = [period, offset] (int32_t x) -> int32_t {
+            x += offset;
+            x = x < 0 ? 0 : x > 32768 ? 32768 : x;
+            return int32_t((uint64_t(x) * period) >> 15);
+        };
+        return { duty(a), duty(b), duty(c) };
+    }
+}
+
+#endif // PERIPH_FOC_H
@@ -4,6 +4,7 @@
 #include "main.h"
 #ifdef HAL_GPIO_MODULE_ENABLED
 
+#include "periph/config.h"
 #include "etl/time.h"
 
 #define GPIO_ACTIVE_HIGH Project::periph::GPIO::activeHigh
@@ -26,7 +27,27 @@ struct Project::periph::GPIO {
     ///     - .pull @ref GPIO_NOPULL (default), @ref GPIO_PULLUP, @ref GPIO_PULLDOWN
     ///     - .speed @ref GPIO_SPEED_FREQ_LOW (default), @ref GPIO_SPEED_FREQ_MEDIUM, @ref GPIO_SPEED_FREQ_HIGH
     void init(InitArgs args) const {
-        // enable clock
+        enableClock(port);
+
+        // hal init
+        GPIO_InitTypeDef gpioInitStruct = { 
+            .Pin = pin,
+            .Mode = args.mode,
+            .Pull = args.pull,
+            .Speed = args.speed,
+        #ifndef STM32F103xB
+            .Alternate = 0
+        #endif
+        };
+        HAL_GPIO_Init(port, &gpioInitStruct);
+
+        // turn off if mode is output
+        if (args.mode == GPIO_MODE_OUTPUT_OD || args.mode == GPIO_MODE_OUTPUT_PP)
+            off();
+    }
+
+    /// enable the clock of a GPIO port, folds to a single RCC access when the port is a constant
+    static void enableClock(GPIO_TypeDef* port) {
         if (port == GPIOA) __HAL_RCC_GPIOA_CLK_ENABLE();
         if (port == GPIOB) __HAL_RCC_GPIOB_CLK_ENABLE();
         if (port == GPIOC) __HAL_RCC_GPIOC_CLK_ENABLE();
@@ -48,37 +69,24 @@ struct Project::periph::GPIO {
         #if defined(GPIOI)
             if (port == GPIOI) __HAL_RCC_GPIOI_CLK_ENABLE();
         #endif
-
-        // hal init
-        GPIO_InitTypeDef gpioInitStruct = { 
-            .Pin = pin,
-            .Mode = args.mode,
-            .Pull = args.pull,
-            .Speed = args.speed,
-        #ifndef STM32F103xB
-            .Alternate = 0
-        #endif
-        };
-        HAL_GPIO_Init(port, &gpioInitStruct);
-
-        // turn off if mode is output
-        if (args.mode == GPIO_MODE_OUTPUT_OD || args.mode == GPIO_MODE_OUTPUT_PP)
-            off();
     }
 
     /// return true if this object is valid
     explicit operator bool() { return bool(port); }
 
     /// write pin high (true) or low (false)
-    void write(bool highLow) const { HAL_GPIO_WritePin(port, pin, highLow ? GPIO_PIN_SET : GPIO_PIN_RESET); }
+    void write(bool highLow) const { port->BSRR = highLow ? uint32_t(pin) : uint32_t(pin) << 16; }
 
-    /// toggle pin
-    void toggle() const { HAL_GPIO_TogglePin(port, pin); }
+    /// toggle pin, only this pin is written
+    void toggle() const {
+        uint32_t odr = port->ODR;
+        port->BSRR = ((odr & pin) << 16) | (~odr & pin);
+    }
 
     /// read pin
     /// @retval high (true) or low (false)
     [[nodiscard]] 
-    bool read() const { return HAL_GPIO_ReadPin(port, pin); }
+    bool read() const { return (port->IDR & pin) != 0; }
 
     struct OnOffArgs { etl::Time sleepFor; };
     static constexpr OnOffArgs OnOffArgsDefault { .sleepFor = etl::time::immediate };
@@ -88,7 +96,7 @@ struct Project::periph::GPIO {
     ///     - .sleepFor sleep for a while. default = time::immediate
     void on(OnOffArgs args = OnOffArgsDefault) const {
         write(activeMode);
-        etl::time::sleep(args.sleepFor);
+        sleep(args.sleepFor);
     }
 
     /// turn off
@@ -96,7 +104,7 @@ struct Project::periph::GPIO {
     ///     - .sleepFor sleep for a while. default = time::immediate
     void off(OnOffArgs args = OnOffArgsDefault) const {
         write(!activeMode);
-        etl::time::sleep(args.sleepFor);
+        sleep(args.sleepFor);
     }
 
     [[nodiscard]] 
@@ -104,6 +112,17 @@ struct Project::periph::GPIO {
     
     [[nodiscard]] 
     bool isOff() const { return (read() ^ activeMode); }
+
+private:
+    /// etl::time::sleep() needs the RTOS, without it wait on the HAL tick
+    static void sleep(etl::Time duration) {
+        #ifdef PERIPH_USE_BARE_METAL
+        if (duration.tick > 0)
+            HAL_Delay(detail::tickToMillis(duration.tick));
+        #else
+        etl::time::sleep(duration);
+        #endif
+    }
 };
 
 #endif
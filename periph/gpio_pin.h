@@ -0,0 +1,167 @@
+#ifndef PERIPH_GPIO_PIN_H
+#define PERIPH_GPIO_PIN_H
+
+#include "main.h"
+#ifdef HAL_GPIO_MODULE_ENABLED
+
+#include "periph/gpio.h"
+
+namespace Project::periph {
+    template <uintptr_t Port, uint16_t Pin, bool ActiveHigh = true> struct GpioPin;
+    template <typename... Pins> struct GpioBus;
+}
+
+/// GPIO pin resolved at compile time.
+/// every access compiles to a single BSRR store or IDR load
+/// @example
+///     using Led = GpioPin<GPIOC_BASE, GPIO_PIN_13, GPIO::activeLow>;
+///     Led::init({.mode=GPIO_MODE_OUTPUT_PP});
+///     Led::on();
+template <uintptr_t Port, uint16_t Pin, bool ActiveHigh>
+struct Project::periph::GpioPin {
+    static constexpr uintptr_t portBase = Port;     ///< GPIOx_BASE
+    static constexpr uint16_t pin = Pin;            ///< GPIO_PIN_x
+    static constexpr bool activeHigh = ActiveHigh;  ///< activeLow or activeHigh
+
+    static_assert(Pin != 0, "pin must be a GPIO_PIN_x mask");
+
+    static GPIO_TypeDef* port() { return reinterpret_cast<GPIO_TypeDef*>(Port); }
+
+    /// hal init GPIO and turn off
+    /// @param args see GPIO::init
+    static void init(GPIO::InitArgs args) {
+        GPIO::enableClock(port());
+
+        GPIO_InitTypeDef gpioInitStruct = {
+            .Pin = Pin,
+            .Mode = args.mode,
+            .Pull = args.pull,
+            .Speed = args.speed,
+        #ifndef STM32F103xB
+            .Alternate = 0
+        #endif
+        };
+        HAL_GPIO_Init(port(), &gpioInitStruct);
+
+        if (args.mode == GPIO_MODE_OUTPUT_OD || args.mode == GPIO_MODE_OUTPUT_PP)
+            off();
+    }
+
+    /// write pin high (true) or low (false)
+    static void write(bool highLow) { port()->BSRR = highLow ? uint32_t(Pin) : uint32_t(Pin) << 16; }
+
+    /// toggle pin, only this pin is written
+    static void toggle() {
+        uint32_t odr = port()->ODR;
+        port()->BSRR = ((odr & Pin) << 16) | (~odr & Pin);
+    }
+
+    /// read pin
+    /// @retval high (true) or low (false)
+    [[nodiscard]]
+    static bool read() { return (port()->IDR & Pin) != 0; }
+
+    static void on() { port()->BSRR = ActiveHigh ? uint32_t(Pin) : uint32_t(Pin) << 16; }
+    static void off() { port()->BSRR = ActiveHigh ? uint32_t(Pin) << 16 : uint32_t(Pin); }
+
+    [[nodiscard]]
+    static bool isOn() { return read() == ActiveHigh; }
+
+    [[nodiscard]]
+    static bool isOff() { return read() != ActiveHigh; }
+};
+
+/// several GpioPin written or read as one value, bit i of the value is the on state of the i-th pin.
+/// pins are grouped per port, each port takes one BSRR store or one IDR load.
+/// pins that are consecutive on one port are written with a shift instead of per bit
+/// @example
+///     using Data = GpioBus<GpioPin<GPIOB_BASE, GPIO_PIN_8>, GpioPin<GPIOB_BASE, GPIO_PIN_9>, GpioPin<GPIOA_BASE, GPIO_PIN_0>>;
+///     Data::write(0b101);
+template <typename... Pins>
+struct Project::periph::GpioBus {
+    static constexpr size_t size = sizeof...(Pins);
+    static_assert(size > 0 && size <= 32, "bus width must be 1..32");
+
+    /// init all pins
+    /// @param args see GPIO::init
+    static void init(GPIO::InitArgs args) { (Pins::init(args), ...); }
+
+    /// write all pins
+    /// @param value bit i is the on state of the i-th pin
+    static void write(uint32_t value) {
+        if constexpr (isContiguous()) {
+            value = (value << shift(0)) ^ inverted(0);
+            port(0)->BSRR = (value & mask(0)) | ((~value & mask(0)) << 16);
+        } else {
+            for (size_t i = 0; i < size; ++i) if (isFirstOfPort(i)) {
+                uint32_t bsrr = 0;
+                for (size_t j = i; j < size; ++j) if (ports[j] == ports[i]) {
+                    bool level = bool((value >> j) & 1) == actives[j];
+                    bsrr |= level ? uint32_t(pins[j]) : uint32_t(pins[j]) << 16;
+                }
+                port(i)->BSRR = bsrr;
+            }
+        }
+    }
+
+    /// read all pins
+    /// @retval bit i is the on state of the i-th pin
+    [[nodiscard]]
+    static uint32_t read() {
+        if constexpr (isContiguous()) {
+            return ((port(0)->IDR ^ inverted(0)) & mask(0)) >> shift(0);
+        } else {
+            uint32_t value = 0;
+            for (size_t i = 0; i < size; ++i) if (isFirstOfPort(i)) {
+                uint32_t idr = port(i)->IDR;
+                for (size_t j = i; j < size; ++j) if (ports[j] == ports[i]) {
+                    bool level = (idr & pins[j]) != 0;
+                    value |= uint32_t(level == actives[j]) << j;
+                }
+            }
+            return value;
+        }
+    }
+
+    static void allOn() { write(size == 32 ? 0xFFFFFFFFu : (1u << size) - 1); }
+    static void allOff() { write(0); }
+
+private:
+    static constexpr uintptr_t ports[] = { Pins::portBase... };
+    static constexpr uint16_t pins[] = { Pins::pin... };
+    static constexpr bool actives[] = { Pins::activeHigh... };
+
+    static GPIO_TypeDef* port(size_t i) { return reinterpret_cast<GPIO_TypeDef*>(ports[i]); }
+
+    static constexpr bool isFirstOfPort(size_t i) {
+        for (size_t j = 0; j < i; ++j) if (ports[j] == ports[i]) return false;
+        return true;
+    }
+
+    static constexpr uint32_t shift(size_t i) { return uint32_t(__builtin_ctz(pins[i])); }
+
+    /// pins of the port of the i-th pin
+    static constexpr uint32_t mask(size_t i) {
+        uint32_t res = 0;
+        for (size_t j = 0; j < size; ++j) if (ports[j] == ports[i]) res |= pins[j];
+        return res;
+    }
+
+    /// active low pins of the port of the i-th pin
+    static constexpr uint32_t inverted(size_t i) {
+        uint32_t res = 0;
+        for (size_t j = 0; j < size; ++j) if (ports[j] == ports[i] && !actives[j]) res |= pins[j];
+        return res;
+    }
+
+    /// one port, single bit pins in ascending consecutive order
+    static constexpr bool isContiguous() {
+        if ((pins[0] & (pins[0] - 1)) != 0) return false;
+        for (size_t j = 0; j < size; ++j)
+            if (ports[j] != ports[0] || pins[j] != (pins[0] << j)) return false;
+        return true;
+    }
+};
+
+#endif // HAL_GPIO_MODULE_ENABLED
+#endif // PERIPH_GPIO_PIN_H
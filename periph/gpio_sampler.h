@@ -0,0 +1,289 @@
+#ifndef PERIPH_GPIO_SAMPLER_H
+#define PERIPH_GPIO_SAMPLER_H
+
+#include "main.h"
+#if defined(HAL_TIM_MODULE_ENABLED) && defined(HAL_DMA_MODULE_ENABLED) && defined(HAL_GPIO_MODULE_ENABLED)
+
+#include "periph/config.h"
+#include "Core/Inc/tim.h"
+#include "etl/function.h"
+
+namespace Project::periph { struct GpioSampler; struct GpioPlayer; struct GpioRle; }
+
+namespace Project::periph::detail {
+    inline constexpr uint32_t gpioNoInputTrigger = 0xFFFFFFFFu;
+
+    /// hold the counter until an edge on the trigger input (TIM_TS_xxx), or start it now
+    inline void gpioArm(TIM_HandleTypeDef& htim, uint32_t inputTrigger) {
+        if (inputTrigger == gpioNoInputTrigger) {
+            htim.Instance->CR1 |= TIM_CR1_CEN;
+            return;
+        }
+
+        TIM_SlaveConfigTypeDef slaveConfig = {};
+        slaveConfig.SlaveMode = TIM_SLAVEMODE_TRIGGER;
+        slaveConfig.InputTrigger = inputTrigger;
+        slaveConfig.TriggerPolarity = TIM_TRIGGERPOLARITY_RISING;
+        slaveConfig.TriggerPrescaler = TIM_TRIGGERPRESCALER_DIV1;
+        HAL_TIM_SlaveConfigSynchro(&htim, &slaveConfig);
+    }
+
+    inline void gpioDisarm(TIM_HandleTypeDef& htim) {
+        htim.Instance->CR1 &= ~TIM_CR1_CEN;
+        htim.Instance->SMCR &= ~TIM_SMCR_SMS;
+        __HAL_TIM_DISABLE_DMA(&htim, TIM_DMA_UPDATE);
+    }
+}
+
+/// sample a GPIO port at the update rate of a timer.
+/// each update event moves IDR into a circular DMA ring, the CPU only runs at each half of the ring.
+/// - streaming: no trigger, each half of the ring is passed to dataCallback, e.g. to GpioRle and USB
+/// - triggered: the halves are searched for the trigger pattern, the capture stops postTrigger samples after it,
+///     the ring then holds the samples before and after the trigger, see sample() and triggerPosition()
+///
+/// an external start condition with no CPU at all is the timer trigger input (StartArgs::inputTrigger)
+/// @note requirements: TIMx update DMA request in circular mode, peripheral to memory, half word,
+///     no peripheral increment. the DMA controller must reach the GPIO bus (e.g. DMA2 on STM32F4)
+struct Project::periph::GpioSampler {
+    using DataCallback = etl::Function<void(const uint16_t*, size_t), void*>;
+    using Callback = etl::Function<void(), void*>;
+    static constexpr uint32_t noInputTrigger = detail::gpioNoInputTrigger;
+
+    /// sample pattern, matches when (sample & mask) == value and, if edge is set, one of the edge pins has changed
+    struct Trigger {
+        uint16_t mask = 0;
+        uint16_t value = 0;
+        uint16_t edge = 0;
+    };
+
+    TIM_HandleTypeDef& htim;            ///< tim handler generated by cubeMX, the update rate is the sample rate
+    GPIO_TypeDef* port;                 ///< GPIOx
+    uint16_t* buffer;                   ///< sample ring
+    uint16_t len;                       ///< sample ring length, even
+    DataCallback dataCallback = {};     ///< streaming mode, invoked from the DMA interrupt with each completed half
+    Callback doneCallback = {};         ///< triggered mode, invoked from the DMA interrupt when the capture is complete
+
+    Trigger trigger = {};
+    uint16_t postTrigger = 0;
+    volatile bool isBusy = false;
+    volatile bool isTriggered = false;
+    uint16_t triggerIndex = 0;          ///< ring index of the trigger sample
+    uint16_t endIndex = 0;              ///< ring index of the oldest sample after the capture stopped
+    uint16_t previous = 0;
+    uint32_t afterTrigger = 0;          ///< samples written since the trigger
+
+    GpioSampler(const GpioSampler&) = delete;               ///< disable copy constructor
+    GpioSampler& operator=(const GpioSampler&) = delete;    ///< disable copy assignment
+
+    struct StartArgs {
+        Trigger trigger = {};
+        uint16_t postTrigger = 0;
+        uint32_t inputTrigger = noInputTrigger;
+    };
+
+    /// start sampling
+    /// @param args
+    ///     - .trigger sample pattern, default none (streaming)
+    ///     - .postTrigger minimum number of samples after the trigger, at most len / 4.
+    ///         the capture stops at the end of the next half of the ring, so at least len / 4 samples before the trigger are kept
+    ///     - .inputTrigger TIM_TS_xxx, start on its rising edge, default start now
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
+    HAL_StatusTypeDef start(StartArgs args) {
+        if (isBusy)
+            return HAL_BUSY;
+
+        trigger = args.trigger;
+        postTrigger = args.postTrigger > len / 4 ? len / 4 : args.postTrigger;
+        isTriggered = false;
+        afterTrigger = 0;
+        previous = uint16_t(port->IDR);
+
+        auto hdma = htim.hdma[TIM_DMA_ID_UPDATE];
+        hdma->Parent = this;
+        hdma->XferHalfCpltCallback = +[] (DMA_HandleTypeDef* h) { static_cast<GpioSampler*>(h->Parent)->complete(0); };
+        hdma->XferCpltCallback = +[] (DMA_HandleTypeDef* h) { static_cast<GpioSampler*>(h->Parent)->complete(1); };
+
+        auto res = HAL_DMA_Start_IT(hdma, uint32_t(reinterpret_cast<uintptr_t>(&port->IDR)), uint32_t(reinterpret_cast<uintptr_t>(buffer)), len);
+        if (res != HAL_OK)
+            return res;
+
+        isBusy = true;
+        __HAL_TIM_ENABLE_DMA(&htim, TIM_DMA_UPDATE);
+        detail::gpioArm(htim, args.inputTrigger);
+        return HAL_OK;
+    }
+
+    /// stop sampling
+    void stop() {
+        detail::gpioDisarm(htim);
+        auto hdma = htim.hdma[TIM_DMA_ID_UPDATE];
+        uint32_t remaining = __HAL_DMA_GET_COUNTER(hdma);
+        endIndex = remaining == 0 || remaining >= len ? 0 : uint16_t(len - remaining);
+        HAL_DMA_Abort(hdma);
+        hdma->Parent = &htim;
+        isBusy = false;
+    }
+
+    /// sample of the stopped capture in chronological order
+    /// @param i 0 is the oldest sample, len - 1 the newest
+    [[nodiscard]]
+    uint16_t sample(size_t i) const { return buffer[(endIndex + i) % len]; }
+
+    /// position of the trigger sample in sample() order
+    [[nodiscard]]
+    size_t triggerPosition() const { return (triggerIndex + len - endIndex) % len; }
+
+private:
+    bool isStreaming() const { return trigger.mask == 0 && trigger.edge == 0; }
+
+    void complete(size_t half) {
+        size_t n = len / 2;
+        uint16_t* samples = buffer + half * n;
+
+        if (isStreaming()) {
+            dataCallback(samples, n);
+            return;
+        }
+
+        if (isTriggered) {
+            afterTrigger += n;
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                uint16_t s = samples[i];
+                bool changed = trigger.edge == 0 || ((s ^ previous) & trigger.edge) != 0;
+                previous = s;
+                if (changed && (s & trigger.mask) == trigger.value) {
+                    isTriggered = true;
+                    triggerIndex = uint16_t(half * n + i);
+                    afterTrigger = n - i - 1;
+                    break;
+                }
+            }
+        }
+
+        if (isTriggered && afterTrigger >= postTrigger) {
+            stop();
+            doneCallback();
+        }
+    }
+};
+
+/// play a buffer of BSRR words to a GPIO port at the update rate of a timer.
+/// only the pins encoded in each word are driven, see word() and encode()
+/// @note requirements: TIMx update DMA request, memory to peripheral, word, no peripheral increment,
+///     normal mode for one shot or circular mode for a repeated pattern.
+///     the DMA controller must reach the GPIO bus (e.g. DMA2 on STM32F4)
+struct Project::periph::GpioPlayer {
+    using Callback = etl::Function<void(), void*>;
+    static constexpr uint32_t noInputTrigger = detail::gpioNoInputTrigger;
+
+    TIM_HandleTypeDef& htim;        ///< tim handler generated by cubeMX, the update rate is the output rate
+    GPIO_TypeDef* port;             ///< GPIOx
+    Callback doneCallback = {};     ///< invoked from the DMA interrupt at the end of the buffer, in normal mode
+    volatile bool isBusy = false;
+
+    GpioPlayer(const GpioPlayer&) = delete;             ///< disable copy constructor
+    GpioPlayer& operator=(const GpioPlayer&) = delete;  ///< disable copy assignment
+
+    struct PlayArgs {
+        const uint32_t* words;
+        uint16_t len;
+        uint32_t inputTrigger = noInputTrigger;
+    };
+
+    /// start playing
+    /// @param args
+    ///     - .words BSRR words, must stay valid until done
+    ///     - .len number of words
+    ///     - .inputTrigger TIM_TS_xxx, start on its rising edge, default start now
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
+    HAL_StatusTypeDef play(PlayArgs args) {
+        if (isBusy)
+            return HAL_BUSY;
+
+        auto hdma = htim.hdma[TIM_DMA_ID_UPDATE];
+        hdma->Parent = this;
+        hdma->XferHalfCpltCallback = nullptr;
+        hdma->XferCpltCallback = +[] (DMA_HandleTypeDef* h) {
+            auto self = static_cast<GpioPlayer*>(h->Parent);
+            if (h->Init.Mode == DMA_CIRCULAR)
+                return;
+            self->stop();
+            self->doneCallback();
+        };
+
+        auto res = HAL_DMA_Start_IT(hdma, uint32_t(reinterpret_cast<uintptr_t>(args.words)), uint32_t(reinterpret_cast<uintptr_t>(&port->BSRR)), args.len);
+        if (res != HAL_OK)
+            return res;
+
+        isBusy = true;
+        __HAL_TIM_ENABLE_DMA(&htim, TIM_DMA_UPDATE);
+        detail::gpioArm(htim, args.inputTrigger);
+        return HAL_OK;
+    }
+
+    /// stop playing, the pins keep their last level
+    void stop() {
+        detail::gpioDisarm(htim);
+        auto hdma = htim.hdma[TIM_DMA_ID_UPDATE];
+        HAL_DMA_Abort(hdma);
+        hdma->Parent = &htim;
+        isBusy = false;
+    }
+
+    /// BSRR word driving the pins of mask to levels
+    static constexpr uint32_t word(uint16_t levels, uint16_t mask) {
+        return (levels & mask) | (uint32_t(uint16_t(~levels) & mask) << 16);
+    }
+
+    /// encode port levels into BSRR words
+    static void encode(const uint16_t* levels, uint32_t* words, size_t n, uint16_t mask) {
+        for (size_t i = 0; i < n; ++i)
+            words[i] = word(levels[i], mask);
+    }
+};
+
+/// run length encoder of port samples, runs may continue across calls
+struct Project::periph::GpioRle {
+    struct Run {
+        uint16_t value;     ///< masked sample
+        uint16_t count;     ///< number of samples, 1..65535
+    };
+
+    uint16_t mask = 0xFFFF; ///< pins of interest
+    Run current = {};
+
+    /// encode samples, the last run is kept until it ends
+    /// @param samples input samples
+    /// @param n number of samples
+    /// @param runs[out] completed runs, room for n runs
+    /// @retval number of runs written
+    size_t encode(const uint16_t* samples, size_t n, Run* runs) {
+        size_t k = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint16_t value = samples[i] & mask;
+            if (current.count > 0 && value == current.value && current.count < 0xFFFF) {
+                current.count++;
+                continue;
+            }
+            if (current.count > 0)
+                runs[k++] = current;
+            current = { value, 1 };
+        }
+        return k;
+    }
+
+    /// emit the run in progress
+    /// @param runs[out] room for one run
+    /// @retval number of runs written
+    size_t flush(Run* runs) {
+        if (current.count == 0)
+            return 0;
+        runs[0] = current;
+        current = {};
+        return 1;
+    }
+};
+
+#endif // HAL_TIM_MODULE_ENABLED && HAL_DMA_MODULE_ENABLED && HAL_GPIO_MODULE_ENABLED
+#endif // PERIPH_GPIO_SAMPLER_H
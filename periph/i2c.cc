@@ -6,7 +6,21 @@ using namespace Project::periph;
 
 detail::UniqueInstances<I2C*, 16> I2C::Instances;
 
+#ifdef PERIPH_USE_REGISTRY
+registry::Slots<I2C, registry::I2c> I2C::Registered;
+
+// F0, L0 and G0 have one combined I2Cx_IRQn, recorded as irqGlobal
+static_assert(registry::any<registry::I2c>(registry::irqEvent, 0) || registry::any<registry::I2c>(registry::irqGlobal, 0),
+    "I2C driver needs an I2C event or global interrupt in the .ioc");
+#ifdef PERIPH_I2C_MEM_WRITE_USE_DMA
+static_assert(registry::any<registry::I2c>(0, registry::dmaTx), "PERIPH_I2C_MEM_WRITE_USE_DMA needs an I2C tx DMA request in the .ioc");
+#endif
+#endif
+
 static I2C* selector(I2C_HandleTypeDef *hi2c) {
+    #ifdef PERIPH_USE_REGISTRY
+    return I2C::Registered.find(hi2c->Instance);
+    #else
     for (auto instance : I2C::Instances.instances) {
         if (instance == nullptr)
             continue;
@@ -16,6 +30,7 @@ static I2C* selector(I2C_HandleTypeDef *hi2c) {
     }
 
     return nullptr;
+    #endif
 }
 
 extern "C" void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
@@ -26,4 +41,20 @@ extern "C" void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
     i2c->txCallback();
 }
 
+extern "C" void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    auto i2c = selector(hi2c);
+    if (i2c == nullptr)
+        return;
+
+    i2c->rxCallback();
+}
+
+extern "C" void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    auto i2c = selector(hi2c);
+    if (i2c == nullptr)
+        return;
+
+    i2c->errorCallback();
+}
+
 #endif
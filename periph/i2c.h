@@ -5,6 +5,7 @@
 #ifdef HAL_I2C_MODULE_ENABLED
 
 #include "periph/config.h"
+#include "periph/registry.h"
 #include "Core/Inc/i2c.h"
 #include "etl/function.h"
 #include "etl/time.h"
@@ -16,28 +17,45 @@ namespace Project::periph { struct I2C; }
 struct Project::periph::I2C {
     using Callback = etl::Function<void(), void*>; 
     static detail::UniqueInstances<I2C*, 16> Instances;
+    #ifdef PERIPH_USE_REGISTRY
+    static registry::Slots<I2C, registry::I2c> Registered; ///< instances indexed by the registry position of hi2c.Instance
+    #endif
 
-    I2C_HandleTypeDef &hi2c;    ///< I2C handler configured by cubeMX
-    Callback txCallback = {};   ///< transmit complete callback function
+    I2C_HandleTypeDef &hi2c;        ///< I2C handler configured by cubeMX
+    Callback txCallback = {};       ///< transmit complete callback function
+    Callback rxCallback = {};       ///< receive complete callback function
+    Callback errorCallback = {};    ///< error callback function
 
     I2C(const I2C&) = delete;               ///< disable copy constructor
     I2C& operator=(const I2C&) = delete;    ///< disable copy assignment
 
     /// register this instance
-    void init() { Instances.push(this); }
+    void init() {
+        Instances.push(this);
+        #ifdef PERIPH_USE_REGISTRY
+        Registered.bind(hi2c.Instance, this);
+        #endif
+    }
 
     /// unregister this instance
-    void deinit() { Instances.pop(this); }
+    void deinit() {
+        Instances.pop(this);
+        #ifdef PERIPH_USE_REGISTRY
+        Registered.unbind(hi2c.Instance, this);
+        #endif
+    }
 
     struct ReadWriteBlockingArgs { 
         uint16_t deviceAddr, memAddr; 
         const uint8_t* buf; uint16_t len; 
         etl::Time timeout = etl::time::infinite; 
+        uint16_t memAddrSize = I2C_MEMADD_SIZE_8BIT;
     };
 
     struct ReadWriteArgs { 
         uint16_t deviceAddr, memAddr; 
         const uint8_t* buf; uint16_t len; 
+        uint16_t memAddrSize = I2C_MEMADD_SIZE_8BIT;
     };
 
     /// I2C write blocking
@@ -47,10 +65,11 @@ struct Project::periph::I2C {
     ///     - .buf pointer to data buffer
     ///     - .len data length
     ///     - .timeout write timeout, default time::infinite
+    ///     - .memAddrSize I2C_MEMADD_SIZE_8BIT (default) or I2C_MEMADD_SIZE_16BIT
     /// @retval HAL_StatusTypeDef. see stm32fXxx_hal_def.h
     int writeBlocking(ReadWriteBlockingArgs args) {
         while (hi2c.State != HAL_I2C_STATE_READY);
-        return HAL_I2C_Mem_Write(&hi2c, args.deviceAddr, args.memAddr, 1, const_cast<uint8_t*>(args.buf), args.len, args.timeout.tick);
+        return HAL_I2C_Mem_Write(&hi2c, args.deviceAddr, args.memAddr, args.memAddrSize, const_cast<uint8_t*>(args.buf), args.len, args.timeout.tick);
     }
 
     /// I2C write non blocking
@@ -59,14 +78,12 @@ struct Project::periph::I2C {
     ///     - .memAddr memory address
     ///     - .buf pointer to data buffer
     ///     - .len data length
+    ///     - .memAddrSize I2C_MEMADD_SIZE_8BIT (default) or I2C_MEMADD_SIZE_16BIT
     /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
     int write(ReadWriteArgs args) {
-        #ifdef PERIPH_I2C_MEM_WRITE_USE_IT
-        return HAL_I2C_Mem_Write_IT(&hi2c, args.deviceAddr, args.memAddr, 1, const_cast<uint8_t*>(args.buf), args.len);
-        #endif
-        #ifdef PERIPH_I2C_MEM_WRITE_USE_DMA
-        return HAL_I2C_Mem_Write_DMA(&hi2c, args.deviceAddr, args.memAddr, 1, const_cast<uint8_t*>(args.buf), args.len);
-        #endif
+        if (isTxDma())
+            return HAL_I2C_Mem_Write_DMA(&hi2c, args.deviceAddr, args.memAddr, args.memAddrSize, const_cast<uint8_t*>(args.buf), args.len);
+        return HAL_I2C_Mem_Write_IT(&hi2c, args.deviceAddr, args.memAddr, args.memAddrSize, const_cast<uint8_t*>(args.buf), args.len);
     }
 
     /// I2C read blocking
@@ -76,10 +93,40 @@ struct Project::periph::I2C {
     ///     - .buf pointer to data buffer
     ///     - .len data length
     ///     - .timeout write timeout, default time::infinite
+    ///     - .memAddrSize I2C_MEMADD_SIZE_8BIT (default) or I2C_MEMADD_SIZE_16BIT
     /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
     int readBlocking(ReadWriteBlockingArgs args) {
         while (hi2c.State != HAL_I2C_STATE_READY);
-        return HAL_I2C_Mem_Read(&hi2c, args.deviceAddr, args.memAddr, 1, const_cast<uint8_t*>(args.buf), args.len, args.timeout.tick);
+        return HAL_I2C_Mem_Read(&hi2c, args.deviceAddr, args.memAddr, args.memAddrSize, const_cast<uint8_t*>(args.buf), args.len, args.timeout.tick);
+    }
+
+    /// I2C read non blocking using DMA, or IT with PERIPH_I2C_MEM_WRITE_USE_AUTO if this instance has no rx DMA.
+    /// rxCallback is invoked when the transfer is complete
+    /// @param args
+    ///     - .deviceAddr device address
+    ///     - .memAddr memory address
+    ///     - .buf pointer to data buffer
+    ///     - .len data length
+    ///     - .memAddrSize I2C_MEMADD_SIZE_8BIT (default) or I2C_MEMADD_SIZE_16BIT
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
+    int read(ReadWriteArgs args) {
+        #ifdef PERIPH_I2C_MEM_WRITE_USE_AUTO
+        if (!registry::useDma<registry::I2c>(hi2c.Instance, registry::dmaRx, hi2c.hdmarx))
+            return HAL_I2C_Mem_Read_IT(&hi2c, args.deviceAddr, args.memAddr, args.memAddrSize, const_cast<uint8_t*>(args.buf), args.len);
+        #endif
+        return HAL_I2C_Mem_Read_DMA(&hi2c, args.deviceAddr, args.memAddr, args.memAddrSize, const_cast<uint8_t*>(args.buf), args.len);
+    }
+
+    /// write transfer mode of this instance, see PERIPH_I2C_MEM_WRITE_USE_xxx
+    [[nodiscard]]
+    bool isTxDma() const {
+        #if defined(PERIPH_I2C_MEM_WRITE_USE_DMA)
+        return true;
+        #elif defined(PERIPH_I2C_MEM_WRITE_USE_AUTO)
+        return registry::useDma<registry::I2c>(hi2c.Instance, registry::dmaTx, hi2c.hdmatx);
+        #else
+        return false;
+        #endif
     }
 };
 
@@ -0,0 +1,165 @@
+#ifndef PERIPH_I2C_POLLER_H
+#define PERIPH_I2C_POLLER_H
+
+#include "main.h"
+#ifdef HAL_I2C_MODULE_ENABLED
+
+#include "periph/i2c.h"
+#include <cstring>
+
+namespace Project::periph { struct I2CPoller; }
+
+/// periodic register block polling over one I2C bus.
+/// due reads are chained back to back from the DMA complete interrupt,
+/// results are published to double buffered snapshots
+/// @note requirements: I2C event and error interrupt, rx DMA
+struct Project::periph::I2CPoller {
+    /// polled register block
+    struct Device {
+        uint16_t deviceAddr;    ///< device address
+        uint16_t memAddr;       ///< first register address
+        uint16_t len;           ///< register block length
+        uint32_t period;        ///< poll period in poller ticks
+        uint8_t* buffer;        ///< storage of 2 * len bytes
+        uint16_t memAddrSize = I2C_MEMADD_SIZE_8BIT;    ///< I2C_MEMADD_SIZE_8BIT or I2C_MEMADD_SIZE_16BIT
+
+        volatile uint32_t sequence = 0; ///< incremented on every published snapshot
+        volatile uint8_t front = 0;     ///< index of the published half of buffer
+        uint32_t overruns = 0;          ///< counts how many times the block became due while still pending
+        uint32_t countdown = 0;
+        bool due = false;
+
+        Device(const Device&) = delete;             ///< disable copy constructor
+        Device& operator=(const Device&) = delete;  ///< disable copy assignment
+
+        /// pointer to the latest snapshot, valid until the next publish
+        [[nodiscard]]
+        const uint8_t* data() const { return buffer + front * len; }
+
+        /// copy the latest snapshot without locking.
+        /// the sequence is read before the copy and checked again after it, a publish in between restarts the copy
+        /// @param dest[out] destination buffer, at least len bytes, untouched if nothing has been published yet
+        /// @retval sequence number of the copied snapshot, 0 if nothing has been published yet
+        uint32_t read(uint8_t* dest) const {
+            uint32_t seq;
+            do {
+                seq = sequence;
+                if (seq == 0)
+                    return 0;
+                __DMB();
+                ::memcpy(dest, buffer + front * len, len);
+                __DMB();
+            } while (seq != sequence);
+            return seq;
+        }
+    };
+
+    I2C& i2c;                   ///< I2C bus
+    detail::UniqueInstances<Device*, PERIPH_I2C_POLLER_MAX_DEVICES> devices = {};
+    Device* volatile current = nullptr; ///< device of the transfer in progress
+    uint32_t errors = 0;                ///< counts failed transfers of the poller
+
+    I2CPoller(const I2CPoller&) = delete;               ///< disable copy constructor
+    I2CPoller& operator=(const I2CPoller&) = delete;    ///< disable copy assignment
+
+    /// take over rx and error callback of the I2C bus and register it
+    void init() {
+        i2c.rxCallback = {+[] (void* self) { static_cast<I2CPoller*>(self)->complete(); }, this};
+        i2c.errorCallback = {+[] (void* self) { static_cast<I2CPoller*>(self)->error(); }, this};
+        i2c.init();
+    }
+
+    /// release the I2C bus callbacks
+    void deinit() {
+        i2c.rxCallback = I2C::Callback();
+        i2c.errorCallback = I2C::Callback();
+        current = nullptr;
+    }
+
+    /// add a device, it becomes due at the next tick
+    void add(Device& device) {
+        device.countdown = 0;
+        device.due = false;
+        devices.push(&device);
+    }
+
+    /// remove a device
+    void remove(Device& device) {
+        devices.pop(&device);
+    }
+
+    /// poller time base, call it at a fixed rate, e.g. from a timer period elapsed interrupt
+    void tick() {
+        for (auto device : devices.instances) {
+            if (device == nullptr)
+                continue;
+
+            if (device->countdown > 0 && --device->countdown > 0)
+                continue;
+
+            device->countdown = device->period;
+            if (device->due || device == current)
+                device->overruns++;
+            device->due = true;
+        }
+
+        if (current == nullptr)
+            next();
+    }
+
+private:
+    void next() {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+
+        if (current != nullptr) {
+            __set_PRIMASK(primask);
+            return;
+        }
+
+        for (auto device : devices.instances) {
+            if (device == nullptr || !device->due)
+                continue;
+
+            uint8_t* back = device->buffer + (device->front ^ 1) * device->len;
+            if (HAL_I2C_Mem_Read_DMA(&i2c.hi2c, device->deviceAddr, device->memAddr, device->memAddrSize, back, device->len) != HAL_OK)
+                break; // bus is taken by another transfer, retry at the next tick
+
+            device->due = false;
+            current = device;
+            break;
+        }
+
+        __set_PRIMASK(primask);
+    }
+
+    // the bus callbacks also fire for transfers started by other drivers, those only let the due devices go next.
+    // while current is set the poller owns the bus, HAL rejects any other transfer until it ends
+
+    void complete() {
+        auto device = current;
+        if (device != nullptr) {
+            device->front ^= 1;
+            __DMB();
+            device->sequence++;
+            current = nullptr;
+        }
+
+        next();
+    }
+
+    void error() {
+        auto device = current;
+        if (device != nullptr) {
+            errors++;
+            device->due = true; // retry at the next tick instead of waiting a full period
+            current = nullptr;
+            return;
+        }
+
+        next();
+    }
+};
+
+#endif // HAL_I2C_MODULE_ENABLED
+#endif // PERIPH_I2C_POLLER_H
@@ -1,4 +1,5 @@
 #include "periph/i2s.h"
+#include "periph/trace.h"
 
 #ifdef HAL_I2S_MODULE_ENABLED
 
@@ -6,8 +7,18 @@ using namespace Project::periph;
 
 detail::UniqueInstances<I2S*, 16> I2S::Instances;
 
+#ifdef PERIPH_USE_REGISTRY
+registry::Slots<I2S, registry::I2s> I2S::Registered;
+
+static_assert(registry::any<registry::I2s>(0, registry::dmaRx | registry::dmaRxCircular | registry::dmaTx | registry::dmaTxCircular),
+    "I2S driver needs circular tx and rx DMA requests in the .ioc");
+#endif
+
 
 static I2S* selector(I2S_HandleTypeDef *hi2s) {
+    #ifdef PERIPH_USE_REGISTRY
+    return I2S::Registered.find(hi2s->Instance);
+    #else
     for (auto instance : I2S::Instances.instances) {
         if (instance == nullptr)
             continue;
@@ -17,21 +28,26 @@ static I2S* selector(I2S_HandleTypeDef *hi2s) {
     }
 
     return nullptr;
+    #endif
 }
 
 extern "C" void HAL_I2SEx_TxRxHalfCpltCallback(I2S_HandleTypeDef *hi2s) {
+    PERIPH_TRACE(trace::sourceI2s);
     auto i2s = selector(hi2s);
     if (i2s == nullptr)
         return;
 
+    PERIPH_TRACE(trace::sourceI2sUser);
     i2s->halfCallback();
 }
 
 extern "C" void HAL_I2SEx_TxRxCpltCallback(I2S_HandleTypeDef *hi2s) {
+    PERIPH_TRACE(trace::sourceI2s);
     auto i2s = selector(hi2s);
     if (i2s == nullptr)
         return;
 
+    PERIPH_TRACE(trace::sourceI2sUser);
     i2s->fullCallback();
 }
 
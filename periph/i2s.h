@@ -5,10 +5,15 @@
 #ifdef HAL_I2S_MODULE_ENABLED
 
 #include "periph/config.h"
+#include "periph/registry.h"
 #include "Core/Inc/i2s.h"
 #include "etl/array.h"
+#include "etl/function.h"
+#include "etl/time.h"
+#ifndef PERIPH_USE_BARE_METAL
 #include "etl/event.h"
 #include "etl/future.h"
+#endif
 
 namespace Project::periph { struct I2S; }
 
@@ -19,8 +24,13 @@ namespace Project::periph { struct I2S; }
 ///     - standard I2S Philips
 ///     - 16 bits data on 16 bits frame
 ///     - tx & rx DMA circular 16 bit
+/// with PERIPH_USE_BARE_METAL there is no flag promise and the future returning read(args) and write(args) do not exist,
+/// use blockCallback or co_await coro::block() and then read(args, fl) or write(args, fl)
 struct Project::periph::I2S {
     static detail::UniqueInstances<I2S*, 16> Instances;
+    #ifdef PERIPH_USE_REGISTRY
+    static registry::Slots<I2S, registry::I2s> Registered; ///< instances indexed by the registry position of hi2s.Instance
+    #endif
 
     typedef int16_t Mono;
     struct Stereo { Mono left, right; };
@@ -43,11 +53,15 @@ struct Project::periph::I2S {
     #endif
     
     enum { FLAG_HALF = 1 << 0, FLAG_FULL = 1 << 1 };
+    using BlockCallback = etl::Function<void(int), void*>;
 
     I2S_HandleTypeDef &hi2s; ///< I2S handler configured in cubeMX
     DualBuffer txBuffer = {};
     DualBuffer rxBuffer = {};
+    #ifndef PERIPH_USE_BARE_METAL
     etl::Promise<int> flag = {};
+    #endif
+    BlockCallback blockCallback = {};   ///< invoked with FLAG_HALF or FLAG_FULL when a half of the buffers is ready
 
     I2S(const I2S&) = delete;               ///< disable copy constructor
     I2S& operator=(const I2S&) = delete;    ///< disable copy assignment
@@ -56,20 +70,32 @@ struct Project::periph::I2S {
     void init() {
         HAL_I2SEx_TransmitReceive_DMA(&hi2s, (uint16_t*) &txBuffer, (uint16_t*) &rxBuffer, DualBuffer::size() * nChannels);
         Instances.push(this);
+        #ifdef PERIPH_USE_REGISTRY
+        Registered.bind(hi2s.Instance, this);
+        #endif
     }
 
     /// stop DMA and unregister this instance
     void deinit() {
         HAL_I2S_DMAStop(&hi2s);
         Instances.pop(this);
+        #ifdef PERIPH_USE_REGISTRY
+        Registered.unbind(hi2s.Instance, this);
+        #endif
     }
 
     void halfCallback() {
+        #ifndef PERIPH_USE_BARE_METAL
         flag.set(FLAG_HALF);
+        #endif
+        blockCallback(FLAG_HALF);
     }
 
     void fullCallback() {
+        #ifndef PERIPH_USE_BARE_METAL
         flag.set(FLAG_FULL);
+        #endif
+        blockCallback(FLAG_FULL);
     }
 
     struct ReadMonoArgs { BufferMono& buffer; bool leftOrRight = false; };
@@ -78,27 +104,34 @@ struct Project::periph::I2S {
     /// @param args 
     ///     - .buffer[out] buffer mono to store the audio data
     ///     - .leftOrRight left (false) or right (true) channel, default left 
-    /// @return osStatus
+    /// @return future resolved when the next block has been copied
+    /// @note not available with PERIPH_USE_BARE_METAL
+    #ifndef PERIPH_USE_BARE_METAL
     etl::Future<void> read(ReadMonoArgs args) {
-        return flag.get_future().then([this, args] (int fl) {
-            auto buf = rxBuffer.begin();
-            if (fl == FLAG_FULL)
-                buf = rxBuffer.begin() + nSamples;
-
-            #ifdef PERIPH_I2S_CHANNEL_STEREO
-            if (args.leftOrRight)
-                for (size_t i = 0; i < nSamples; i++)
-                    args.buffer[i] = buf[i].right;
-            else
-                for (size_t i = 0; i < nSamples; i++)
-                    args.buffer[i] = buf[i].left;
-            #endif
-            #ifdef PERIPH_I2S_CHANNEL_MONO
-            UNUSED(args.leftOrRight);
+        return flag.get_future().then([this, args] (int fl) { read(args, fl); });
+    }
+    #endif
+
+    /// read one block now, e.g. from blockCallback or after co_await coro::block()
+    /// @param fl FLAG_HALF or FLAG_FULL, the half of the buffers just transferred
+    void read(ReadMonoArgs args, int fl) {
+        auto buf = rxBuffer.begin();
+        if (fl == FLAG_FULL)
+            buf = rxBuffer.begin() + nSamples;
+
+        #ifdef PERIPH_I2S_CHANNEL_STEREO
+        if (args.leftOrRight)
+            for (size_t i = 0; i < nSamples; i++)
+                args.buffer[i] = buf[i].right;
+        else
             for (size_t i = 0; i < nSamples; i++)
-                args.buffer[i] = buf[i];
-            #endif
-        });
+                args.buffer[i] = buf[i].left;
+        #endif
+        #ifdef PERIPH_I2S_CHANNEL_MONO
+        UNUSED(args.leftOrRight);
+        for (size_t i = 0; i < nSamples; i++)
+            args.buffer[i] = buf[i];
+        #endif
     }
 
     struct ReadStereoArgs { BufferStereo& buffer; };
@@ -106,24 +139,31 @@ struct Project::periph::I2S {
     /// read audio data and store to buffer stereo
     /// @param args 
     ///     - .buffer[out] buffer stereo to store the audio data
-    /// @return osStatus
+    /// @return future resolved when the next block has been copied
+    /// @note not available with PERIPH_USE_BARE_METAL
+    #ifndef PERIPH_USE_BARE_METAL
     etl::Future<void> read(ReadStereoArgs args) {
-        return flag.get_future().then([this, args] (int fl) {
-            auto buf = rxBuffer.begin();
-            if (fl == FLAG_FULL)
-                buf = rxBuffer.begin() + nSamples;
+        return flag.get_future().then([this, args] (int fl) { read(args, fl); });
+    }
+    #endif
 
-            #ifdef PERIPH_I2S_CHANNEL_STEREO
-            for (size_t i = 0; i < nSamples; i++)
-                args.buffer[i] = buf[i];
-            #endif
-            #ifdef PERIPH_I2S_CHANNEL_MONO
-            for (size_t i = 0; i < nSamples; i++) {
-                args.buffer[i].left = buf[i];
-                args.buffer[i].right = buf[i];
-            }
-            #endif
-        });
+    /// read one block now, e.g. from blockCallback or after co_await coro::block()
+    /// @param fl FLAG_HALF or FLAG_FULL, the half of the buffers just transferred
+    void read(ReadStereoArgs args, int fl) {
+        auto buf = rxBuffer.begin();
+        if (fl == FLAG_FULL)
+            buf = rxBuffer.begin() + nSamples;
+
+        #ifdef PERIPH_I2S_CHANNEL_STEREO
+        for (size_t i = 0; i < nSamples; i++)
+            args.buffer[i] = buf[i];
+        #endif
+        #ifdef PERIPH_I2S_CHANNEL_MONO
+        for (size_t i = 0; i < nSamples; i++) {
+            args.buffer[i].left = buf[i];
+            args.buffer[i].right = buf[i];
+        }
+        #endif
     }
 
     struct WriteMonoArgs { const BufferMono& buffer; bool leftOrRight = false; };
@@ -132,27 +172,34 @@ struct Project::periph::I2S {
     /// @param args 
     ///     - .buffer[in] audio data as buffer mono
     ///     - .leftOrRight left (false) or right (true) channel, default left 
-    /// @return osStatus
+    /// @return future resolved when the next block has been copied
+    /// @note not available with PERIPH_USE_BARE_METAL
+    #ifndef PERIPH_USE_BARE_METAL
     etl::Future<void> write(WriteMonoArgs args) {
-        return flag.get_future().then([this, args] (int fl) {
-            auto buf = rxBuffer.begin();
-            if (fl == FLAG_HALF)
-                buf = rxBuffer.begin() + nSamples;
-
-            #ifdef PERIPH_I2S_CHANNEL_STEREO
-            if (args.leftOrRight)
-                for (size_t i = 0; i < nSamples; i++)
-                    buf[i].right = args.buffer[i];
-            else
-                for (size_t i = 0; i < nSamples; i++)
-                    buf[i].left = args.buffer[i];
-            #endif
-            #ifdef PERIPH_I2S_CHANNEL_MONO
-            UNUSED(args.leftOrRight);
+        return flag.get_future().then([this, args] (int fl) { write(args, fl); });
+    }
+    #endif
+
+    /// write one block now, e.g. from blockCallback or after co_await coro::block()
+    /// @param fl FLAG_HALF or FLAG_FULL, the half of the buffers just transferred
+    void write(WriteMonoArgs args, int fl) {
+        auto buf = txBuffer.begin();
+        if (fl == FLAG_HALF)
+            buf = txBuffer.begin() + nSamples;
+
+        #ifdef PERIPH_I2S_CHANNEL_STEREO
+        if (args.leftOrRight)
+            for (size_t i = 0; i < nSamples; i++)
+                buf[i].right = args.buffer[i];
+        else
             for (size_t i = 0; i < nSamples; i++)
-                buf[i] = args.buffer[i];
-            #endif
-        });
+                buf[i].left = args.buffer[i];
+        #endif
+        #ifdef PERIPH_I2S_CHANNEL_MONO
+        UNUSED(args.leftOrRight);
+        for (size_t i = 0; i < nSamples; i++)
+            buf[i] = args.buffer[i];
+        #endif
     }
 
     struct WriteStereoArgs { const BufferStereo& buffer; };
@@ -161,22 +208,29 @@ struct Project::periph::I2S {
     /// @param args 
     ///     - .buffer[in] audio data as buffer stereo
     ///     - .leftOrRight left (false) or right (true) channel, default left 
-    /// @return osStatus
+    /// @return future resolved when the next block has been copied
+    /// @note not available with PERIPH_USE_BARE_METAL
+    #ifndef PERIPH_USE_BARE_METAL
     etl::Future<void> write(WriteStereoArgs args) {
-        return flag.get_future().then([this, args] (int fl) {
-            auto buf = rxBuffer.begin();
-            if (fl == FLAG_HALF)
-                buf = rxBuffer.begin() + nSamples;
+        return flag.get_future().then([this, args] (int fl) { write(args, fl); });
+    }
+    #endif
 
-            #ifdef PERIPH_I2S_CHANNEL_STEREO
-            for (size_t i = 0; i < nSamples; i++)
-                buf[i] = args.buffer[i];
-            #endif
-            #ifdef PERIPH_I2S_CHANNEL_MONO
-            for (size_t i = 0; i < nSamples; i++)
-                buf[i] = args.buffer[i].left / 2 + args.buffer[i].right / 2;
-            #endif
-        });
+    /// write one block now, e.g. from blockCallback or after co_await coro::block()
+    /// @param fl FLAG_HALF or FLAG_FULL, the half of the buffers just transferred
+    void write(WriteStereoArgs args, int fl) {
+        auto buf = txBuffer.begin();
+        if (fl == FLAG_HALF)
+            buf = txBuffer.begin() + nSamples;
+
+        #ifdef PERIPH_I2S_CHANNEL_STEREO
+        for (size_t i = 0; i < nSamples; i++)
+            buf[i] = args.buffer[i];
+        #endif
+        #ifdef PERIPH_I2S_CHANNEL_MONO
+        for (size_t i = 0; i < nSamples; i++)
+            buf[i] = args.buffer[i].left / 2 + args.buffer[i].right / 2;
+        #endif
     }
 };
 
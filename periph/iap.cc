@@ -0,0 +1,89 @@
+#include "periph/iap.h"
+
+#ifdef HAL_FLASH_MODULE_ENABLED
+
+using namespace Project::periph;
+
+uint32_t IAP::checksum(const uint32_t* words, size_t n) {
+    __HAL_RCC_CRC_CLK_ENABLE();
+    CRC->CR = CRC_CR_RESET;
+    for (size_t i = 0; i < n; ++i)
+        CRC->DR = words[i];
+    return CRC->DR;
+}
+
+#ifndef PERIPH_IAP_USE_CUSTOM_BACKEND
+#if !defined(STM32F1) && !defined(STM32F2) && !defined(STM32F3) && !defined(STM32F4)
+#error "IAP::defaultBackend() supports STM32F1 to F4, define PERIPH_IAP_USE_CUSTOM_BACKEND and set IAP::backend"
+#endif
+
+static uint32_t flashErase(uint32_t address) {
+    FLASH_EraseInitTypeDef erase = {};
+    uint32_t error = 0;
+    uint32_t next;
+
+    #if defined(STM32F1) || defined(STM32F3)
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.PageAddress = address & ~(FLASH_PAGE_SIZE - 1);
+    erase.NbPages = 1;
+    next = erase.PageAddress + FLASH_PAGE_SIZE;
+    #elif defined(STM32F2) || defined(STM32F4)
+    // 4 x 16K, 64K, 128K... per 1M bank
+    uint32_t offset = (address - FLASH_BASE) & 0xFFFFF;
+    uint32_t bank = (address - FLASH_BASE) >> 20;
+    uint32_t sector;
+    uint32_t start;
+    if (offset < 0x10000) {
+        sector = offset >> 14;
+        start = sector << 14;
+        next = start + 0x4000;
+    } else if (offset < 0x20000) {
+        sector = 4;
+        start = 0x10000;
+        next = 0x20000;
+    } else {
+        sector = 5 + ((offset - 0x20000) >> 17);
+        start = 0x20000 + ((sector - 5) << 17);
+        next = start + 0x20000;
+    }
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = sector + bank * 12;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+    next += FLASH_BASE + (bank << 20);
+    #endif
+
+    HAL_FLASH_Unlock();
+    auto res = HAL_FLASHEx_Erase(&erase, &error);
+    HAL_FLASH_Lock();
+    return res == HAL_OK ? next : 0;
+}
+
+static bool flashProgram(uint32_t address, const uint8_t* data, size_t len) {
+    HAL_FLASH_Unlock();
+    auto res = HAL_OK;
+
+    #if defined(STM32F1) || defined(STM32F3)
+    for (size_t i = 0; i < len && res == HAL_OK; i += 2) {
+        uint16_t half;
+        ::memcpy(&half, data + i, 2);
+        res = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, address + i, half);
+    }
+    #else
+    for (size_t i = 0; i < len && res == HAL_OK; i += 4) {
+        uint32_t word;
+        ::memcpy(&word, data + i, 4);
+        res = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address + i, word);
+    }
+    #endif
+
+    HAL_FLASH_Lock();
+    return res == HAL_OK;
+}
+
+IAP::Backend IAP::defaultBackend() {
+    return { flashErase, flashProgram };
+}
+#endif // PERIPH_IAP_USE_CUSTOM_BACKEND
+
+#endif // HAL_FLASH_MODULE_ENABLED
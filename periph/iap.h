@@ -0,0 +1,213 @@
+#ifndef PERIPH_IAP_H
+#define PERIPH_IAP_H
+
+#include "main.h"
+#ifdef HAL_FLASH_MODULE_ENABLED
+
+#include "periph/config.h"
+#include "etl/function.h"
+#include <cstring>
+
+namespace Project::periph { struct IAP; }
+
+/// in application firmware update into the inactive one of two flash slots.
+/// bytes from any stream are collected into a double buffer by feed(), usually from an rx callback,
+/// while process() programs the previous block from a task and erases the next sector ahead of the write pointer.
+/// finish() verifies the programmed image with the hardware CRC unit and activates the slot.
+/// defaultBackend() supports STM32F1 to F4, other families define PERIPH_IAP_USE_CUSTOM_BACKEND and set backend.
+/// erasing or programming flash stalls every fetch from the same bank, interrupts included:
+/// a 128K F4 sector takes 1 to 2 s at 2.7-3.6 V, an F1 page about 20 ms. with the slots in the bank the CPU runs from,
+/// process() freezes the whole CPU for that long and the stream has to hold or buffer the data meanwhile
+/// (e.g. UART DMA into RAM, USB NAK). a dual bank part with the slots in the other bank keeps running
+/// @note requirements: slots aligned to flash sectors. the running slot must not share a sector with the other
+/// @example
+///     IAP iap = { .slots = {{0x08020000, 0x60000}, {0x08080000, 0x60000}}, .activate = {setBootSlot, nullptr} };
+///     iap.begin(imageLength);
+///     uart.rxCallbackList.push({+[] (void* iap, const uint8_t* buf, size_t len) { static_cast<IAP*>(iap)->feed(buf, len); }, &iap});
+///     while (iap.process() == IAP::stateReceiving) etl::this_thread::sleep(1ms);
+///     iap.finish(imageCrc);
+struct Project::periph::IAP {
+    struct Slot {
+        uint32_t address;   ///< first byte, sector aligned
+        uint32_t size;      ///< bytes
+    };
+
+    /// flash access, defaultBackend() uses the HAL flash driver
+    struct Backend {
+        uint32_t (*erase)(uint32_t address);                                ///< erase the sector of address, returns the address after the sector or 0 on error
+        bool (*program)(uint32_t address, const uint8_t* data, size_t len); ///< program len bytes, len is a multiple of 8
+    };
+
+    using ActivateCallback = etl::Function<bool(size_t), void*>;    ///< make the slot of the given index the boot slot
+
+    enum { stateIdle, stateReceiving, stateProgrammed, stateDone, stateError };
+
+    Slot slots[2];                          ///< A and B slot
+    size_t active = 0;                      ///< index of the running slot
+    ActivateCallback activate = {};         ///< invoked by finish() with the index of the verified slot
+    #ifdef PERIPH_IAP_USE_CUSTOM_BACKEND
+    Backend backend = {};                   ///< flash access of this family, must be set
+    #else
+    Backend backend = defaultBackend();
+    #endif
+
+    uint8_t blocks[2][PERIPH_IAP_BLOCK_SIZE] = {};
+    size_t fill[2] = {};                    ///< bytes in each block
+    volatile bool ready[2] = {};            ///< block is full and waits to be programmed
+    size_t receiving = 0;                   ///< block filled by feed()
+    size_t programming = 0;                 ///< block programmed next by process()
+
+    uint32_t length = 0;                    ///< image length
+    volatile uint32_t received = 0;         ///< bytes accepted by feed()
+    uint32_t writeAddress = 0;              ///< next flash address to program
+    uint32_t erasedUntil = 0;               ///< first flash address not erased yet
+    uint32_t overruns = 0;                  ///< counts feed() calls that found both blocks full
+    volatile int state = stateIdle;
+
+    IAP(const IAP&) = delete;               ///< disable copy constructor
+    IAP& operator=(const IAP&) = delete;    ///< disable copy assignment
+
+    /// index of the slot receiving the update
+    [[nodiscard]]
+    size_t target() const { return active ^ 1; }
+
+    /// prepare an update of the inactive slot and erase its first sector
+    /// @param imageLength number of bytes that will be fed
+    /// @retval false if the image does not fit the slot or the erase failed
+    bool begin(uint32_t imageLength) {
+        auto& slot = slots[target()];
+        if (imageLength == 0 || imageLength > slot.size)
+            return false;
+
+        length = imageLength;
+        received = 0;
+        fill[0] = fill[1] = 0;
+        ready[0] = ready[1] = false;
+        receiving = programming = 0;
+        overruns = 0;
+        writeAddress = erasedUntil = slot.address;
+        state = stateReceiving;
+
+        if (!eraseAhead(slot.address + 1))
+            return false;
+        return true;
+    }
+
+    /// collect image bytes, may be called from interrupt context
+    /// @param data received bytes
+    /// @param len number of bytes
+    /// @retval number of bytes accepted, less than len if both blocks wait to be programmed or the image is complete
+    size_t feed(const uint8_t* data, size_t len) {
+        size_t accepted = 0;
+        while (accepted < len && state == stateReceiving && received < length) {
+            size_t i = receiving;
+            if (ready[i]) {
+                overruns++;
+                break;
+            }
+
+            size_t n = len - accepted;
+            if (n > PERIPH_IAP_BLOCK_SIZE - fill[i]) n = PERIPH_IAP_BLOCK_SIZE - fill[i];
+            if (n > length - received) n = length - received;
+
+            ::memcpy(blocks[i] + fill[i], data + accepted, n);
+            fill[i] += n;
+            accepted += n;
+            received = received + n;
+
+            if (fill[i] == PERIPH_IAP_BLOCK_SIZE || received == length) {
+                __DMB();
+                ready[i] = true;
+                receiving = i ^ 1;
+            }
+        }
+        return accepted;
+    }
+
+    /// program the received blocks and erase the next sector ahead of them, call it from a task.
+    /// an erase of the bank the CPU runs from blocks the CPU until it is done, see above
+    /// @retval stateReceiving while more bytes are expected, stateProgrammed once the whole image is programmed, or stateError
+    int process() {
+        while (state == stateReceiving && ready[programming]) {
+            size_t i = programming;
+            size_t n = fill[i];
+            size_t padded = (n + 7) & ~size_t(7);
+            ::memset(blocks[i] + n, 0xFF, padded - n);
+
+            if (!eraseAhead(writeAddress + padded) || !backend.program(writeAddress, blocks[i], padded)) {
+                state = stateError;
+                break;
+            }
+
+            writeAddress += uint32_t(n);
+            fill[i] = 0;
+            __DMB();
+            ready[i] = false;
+            programming = i ^ 1;
+
+            if (writeAddress - slots[target()].address == length) {
+                state = stateProgrammed;
+                break;
+            }
+
+            // erase the next sector while the other block is being received
+            if (!eraseAhead(writeAddress + 2 * PERIPH_IAP_BLOCK_SIZE))
+                state = stateError;
+        }
+        return state;
+    }
+
+    /// program the remaining blocks, verify the slot and activate it
+    /// @param crc expected CRC-32/MPEG-2 of the image padded with 0xFF to a multiple of 4 bytes
+    /// @retval false if the image is incomplete, the CRC does not match, or the activation failed
+    bool finish(uint32_t crc) {
+        if (process() != stateProgrammed)
+            return false;
+
+        auto& slot = slots[target()];
+        if (checksum(reinterpret_cast<const uint32_t*>(slot.address), (length + 3) / 4) != crc) {
+            state = stateError;
+            return false;
+        }
+
+        if (activate && !activate(target())) {
+            state = stateError;
+            return false;
+        }
+
+        active = target();
+        state = stateDone;
+        return true;
+    }
+
+    /// abandon the update
+    void abort() { state = stateIdle; }
+
+    /// CRC-32/MPEG-2 of words with the CRC unit
+    static uint32_t checksum(const uint32_t* words, size_t n);
+
+    #ifndef PERIPH_IAP_USE_CUSTOM_BACKEND
+    /// backend programming the internal flash with the HAL flash driver, STM32F1 to F4
+    static Backend defaultBackend();
+    #endif
+
+private:
+    /// erase sectors until the address, within the image
+    bool eraseAhead(uint32_t until) {
+        auto& slot = slots[target()];
+        uint32_t end = slot.address + ((length + 7) & ~uint32_t(7));
+        if (until > end)
+            until = end;
+
+        while (erasedUntil < until) {
+            uint32_t next = backend.erase(erasedUntil);
+            if (next <= erasedUntil)
+                return false;
+            erasedUntil = next;
+        }
+        return true;
+    }
+};
+
+#endif // HAL_FLASH_MODULE_ENABLED
+#endif // PERIPH_IAP_H
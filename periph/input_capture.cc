@@ -1,5 +1,4 @@
 #include "periph/input_capture.h"
-#include "periph/encoder.h"
 
 #ifdef HAL_TIM_MODULE_ENABLED
 
@@ -7,48 +6,8 @@ using namespace Project::periph;
 
 detail::UniqueInstances<InputCapture*, 16> InputCapture::Instances;
 
-static HAL_TIM_ActiveChannel activeChannel(uint32_t channel) {
-    switch (channel) {
-        case TIM_CHANNEL_1: return HAL_TIM_ACTIVE_CHANNEL_1;
-        case TIM_CHANNEL_2: return HAL_TIM_ACTIVE_CHANNEL_2;
-        case TIM_CHANNEL_3: return HAL_TIM_ACTIVE_CHANNEL_3;
-        case TIM_CHANNEL_4: return HAL_TIM_ACTIVE_CHANNEL_4;
-        default: return HAL_TIM_ACTIVE_CHANNEL_CLEARED;
-    }
-}
-
-static InputCapture* selector(TIM_HandleTypeDef *htim) {
-    for (auto instance : InputCapture::Instances.instances) {
-        if (instance == nullptr)
-            continue;
-
-        if (htim->Instance == instance->htim.Instance && htim->Channel == activeChannel(instance->channel))
-            return instance;
-    }
-    
-    return nullptr;
-}
-
-static Encoder* selectorEncoder(TIM_HandleTypeDef *htim) {
-    for (auto instance : Encoder::Instances.instances) {
-        if (instance == nullptr)
-            continue;
-
-        if (htim->Instance == instance->htim.Instance)
-            return instance;
-    }
-
-    return nullptr;
-}
-
-extern "C" void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
-    auto ic = selector(htim);
-    if (ic) {
-        ic->value.set(HAL_TIM_ReadCapturedValue(&ic->htim, ic->channel));
-    }
-
-    auto enc = selectorEncoder(htim);
-    if (enc) enc->inputCaptureCallback();
-}
+#if defined(PERIPH_USE_REGISTRY) && defined(PERIPH_INPUT_CAPTURE_USE_DMA)
+static_assert(registry::anyChannel(registry::modeCapture, registry::dmaRx), "PERIPH_INPUT_CAPTURE_USE_DMA needs an input capture channel with a DMA request in the .ioc");
+#endif
 
 #endif
@@ -5,16 +5,22 @@
 #ifdef HAL_TIM_MODULE_ENABLED
 
 #include "periph/config.h"
+#include "periph/tim_router.h"
 #include "Core/Inc/tim.h"
 #include "etl/getter_setter.h"
+#include "etl/function.h"
+#ifndef PERIPH_USE_BARE_METAL
 #include "etl/future.h"
+#endif
 
 namespace Project::periph { struct InputCapture; }
 
 /// input capture
 /// @note requirements: TIMx input capture mode, TIMx global interrupt
+///     with PERIPH_USE_BARE_METAL the value promise does not exist, use captureCallback
 struct Project::periph::InputCapture {
     using Callback = etl::Function<void(), void*>;
+    using CaptureCallback = etl::Function<void(uint32_t), void*>;
 
     template <typename T>
     using GetterSetter = etl::GetterSetter<T, etl::Function<T(), const InputCapture*>, etl::Function<void(T), const InputCapture*>>;
@@ -23,34 +29,56 @@ struct Project::periph::InputCapture {
 
     TIM_HandleTypeDef& htim;        ///< TIM handler configured by cubeMX
     uint32_t channel;               ///< TIM_CHANNEL_x
-    etl::Promise<uint32_t> value;
+    #ifndef PERIPH_USE_BARE_METAL
+    etl::Promise<uint32_t> value;   ///< set with each captured counter value, not available with PERIPH_USE_BARE_METAL
+    #endif
+    CaptureCallback captureCallback = {};   ///< invoked with the captured counter value, in interrupt context
+    bool isDma = false;             ///< capturing with DMA, see PERIPH_INPUT_CAPTURE_USE_xxx
 
     InputCapture(const InputCapture&) = delete;             ///< disable copy constructor
     InputCapture& operator=(const InputCapture&) = delete;  ///< disable copy assignment
 
-    /// start input capture and register this instance
+    /// start input capture and register this instance.
+    /// with PERIPH_INPUT_CAPTURE_USE_AUTO the captures go to dmaBuffer if it is given and the channel has a DMA request,
+    /// otherwise each capture interrupts
     void init(
-        #ifdef PERIPH_PWM_USE_DMA
+        #if defined(PERIPH_INPUT_CAPTURE_USE_DMA)
         uint32_t* dmaBuffer, uint16_t len
+        #elif defined(PERIPH_INPUT_CAPTURE_USE_AUTO)
+        uint32_t* dmaBuffer = nullptr, uint16_t len = 0
         #endif
     ) { 
-        #ifdef PERIPH_INPUT_CAPTURE_USE_IT
+        #if defined(PERIPH_INPUT_CAPTURE_USE_IT)
         HAL_TIM_IC_Start_IT(&htim, channel); 
-        #endif 
-        #ifdef PERIPH_INPUT_CAPTURE_USE_DMA
-        HAL_TIM_IC_Start_DMA(&htim, channel, dmaBuffer, len); 
+        #else
+        #if defined(PERIPH_INPUT_CAPTURE_USE_DMA)
+        isDma = true;
+        #else
+        isDma = dmaBuffer != nullptr && registry::useDma(htim.Instance, channel, registry::dmaRx, htim.hdma[TIM_DMA_ID_CC1 + (channel >> 2)]);
         #endif
+        if (isDma)
+            HAL_TIM_IC_Start_DMA(&htim, channel, dmaBuffer, len);
+        else
+            HAL_TIM_IC_Start_IT(&htim, channel);
+        #endif
+        TimRouter::attach(htim, TimRouter::eventCapture, channel, {+[] (void* self) { 
+            auto ic = static_cast<InputCapture*>(self);
+            uint32_t captured = HAL_TIM_ReadCapturedValue(&ic->htim, ic->channel);
+            #ifndef PERIPH_USE_BARE_METAL
+            ic->value.set(captured);
+            #endif
+            ic->captureCallback(captured);
+        }, this});
         Instances.push(this);
     }
 
     /// stop input capture and unregister this instance
     void deinit() { 
-        #ifdef PERIPH_INPUT_CAPTURE_USE_IT
-        HAL_TIM_IC_Stop_IT(&htim, channel); 
-        #endif 
-        #ifdef PERIPH_INPUT_CAPTURE_USE_DMA
-        HAL_TIM_IC_Stop_DMA(&htim, channel); 
-        #endif
+        if (isDma)
+            HAL_TIM_IC_Stop_DMA(&htim, channel);
+        else
+            HAL_TIM_IC_Stop_IT(&htim, channel);
+        TimRouter::detach(htim, TimRouter::eventCapture, channel);
         Instances.pop(this);
     }
 
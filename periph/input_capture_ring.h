@@ -0,0 +1,236 @@
+#ifndef PERIPH_INPUT_CAPTURE_RING_H
+#define PERIPH_INPUT_CAPTURE_RING_H
+
+#include "main.h"
+#ifdef HAL_TIM_MODULE_ENABLED
+
+#include "periph/config.h"
+#include "periph/tim_router.h"
+#include "Core/Inc/tim.h"
+
+namespace Project::periph { struct InputCaptureRing; }
+
+/// input capture into a circular DMA ring with batched period, frequency, and duty measurement.
+/// the CPU only touches the captures when measure() is called, the DMA half transfer interrupt is disabled.
+/// the DMA transfer complete interrupt counts the laps of each ring, so measure() knows how many edges arrived
+/// even when more than len did and the oldest captures were overwritten.
+/// in free running mode the update interrupt counts the counter overflows, the timestamps are extended to 64 bits
+/// across any number of counter periods and the mean period only needs the newest capture of each window.
+/// @note requirements: TIMx input capture mode, TIMx CCx DMA circular word transfers, TIMx global interrupt.
+///     in free running mode HAL_TIM_PeriodElapsedCallback has to call TimRouter::dispatch(htim, TimRouter::eventUpdate)
+///     and this instance takes the update handler of the timer.
+///     in reset mode (PWM input mode, slave reset on the rising edge) a period must be shorter than one counter period.
+///     duty is only measured in reset mode, with the falling edges captured on dutyChannel
+struct Project::periph::InputCaptureRing {
+    struct Measurement {
+        uint32_t edges;     ///< number of periods in the window
+        float period;       ///< mean period in timer ticks
+        float frequency;    ///< mean frequency in Hz
+        float duty;         ///< mean duty cycle 0..1, 0 if not in reset mode or dutyBuffer is not used
+        uint32_t overrun;   ///< edges overwritten before this call, len or more arrived since the last call.
+                            ///< free running mode still measures the window, reset mode drops it
+    };
+
+    TIM_HandleTypeDef& htim;        ///< TIM handler configured by cubeMX
+    uint32_t channel;               ///< TIM_CHANNEL_x capturing the rising edges
+    uint32_t* buffer;               ///< capture ring
+    uint16_t len;                   ///< capture ring length, more than the number of edges between two measure() calls
+    uint32_t clock;                 ///< timer kernel clock in Hz
+    bool resetMode = false;         ///< counter is reset at each capture (PWM input mode), captures are periods
+    uint32_t dutyChannel = TIM_CHANNEL_2;   ///< TIM_CHANNEL_x capturing the falling edges in PWM input mode
+    uint32_t* dutyBuffer = nullptr; ///< falling edge capture ring of the same length, nullptr to disable duty measurement
+
+    uint64_t timestamp = 0;         ///< extended timestamp of the last edge in timer ticks, free running mode
+    uint16_t tail = 0;
+    uint16_t dutyTail = 0;
+    uint32_t consumed = 0;          ///< edges read from buffer, modulo 2^32
+    uint32_t dutyConsumed = 0;      ///< edges read from dutyBuffer, modulo 2^32
+    uint32_t lastCapture = 0;
+    uint32_t lastOverflows = 0;
+    bool hasLastCapture = false;
+
+    volatile uint32_t laps = 0;         ///< DMA transfer complete count of buffer
+    volatile uint32_t dutyLaps = 0;     ///< DMA transfer complete count of dutyBuffer
+    volatile uint32_t overflows = 0;    ///< update events, free running mode
+
+    // the newest update event that followed new edges, the edges before markWritten have markOverflows overflows,
+    // or one more if they were captured between the overflow and the interrupt (capture <= markCounter)
+    volatile uint32_t markWritten = 0;
+    volatile uint32_t markOverflows = 0;
+    volatile uint32_t markCounter = 0;
+
+    InputCaptureRing(const InputCaptureRing&) = delete;             ///< disable copy constructor
+    InputCaptureRing& operator=(const InputCaptureRing&) = delete;  ///< disable copy assignment
+
+    /// start circular DMA capture.
+    /// in free running mode the first measure() only starts the window
+    void init() {
+        tail = dutyTail = 0;
+        consumed = dutyConsumed = 0;
+        laps = dutyLaps = 0;
+        overflows = markWritten = markOverflows = markCounter = 0;
+        hasLastCapture = false;
+        timestamp = 0;
+
+        TimRouter::attach(htim, TimRouter::eventCapture, channel, {+[] (void* self) {
+            auto ring = static_cast<InputCaptureRing*>(self);
+            ring->laps = ring->laps + 1;
+        }, this});
+        HAL_TIM_IC_Start_DMA(&htim, channel, buffer, len);
+        __HAL_DMA_DISABLE_IT(dma(channel), DMA_IT_HT);
+
+        if (hasDuty()) {
+            TimRouter::attach(htim, TimRouter::eventCapture, dutyChannel, {+[] (void* self) {
+                auto ring = static_cast<InputCaptureRing*>(self);
+                ring->dutyLaps = ring->dutyLaps + 1;
+            }, this});
+            HAL_TIM_IC_Start_DMA(&htim, dutyChannel, dutyBuffer, len);
+            __HAL_DMA_DISABLE_IT(dma(dutyChannel), DMA_IT_HT);
+        }
+
+        if (!resetMode) {
+            TimRouter::attach(htim, TimRouter::eventUpdate, 0, {+[] (void* self) {
+                static_cast<InputCaptureRing*>(self)->updateCallback();
+            }, this});
+            __HAL_TIM_CLEAR_IT(&htim, TIM_IT_UPDATE);
+            __HAL_TIM_ENABLE_IT(&htim, TIM_IT_UPDATE);
+        }
+    }
+
+    /// stop capture
+    void deinit() {
+        if (!resetMode) {
+            __HAL_TIM_DISABLE_IT(&htim, TIM_IT_UPDATE);
+            TimRouter::detach(htim, TimRouter::eventUpdate, 0);
+        }
+
+        HAL_TIM_IC_Stop_DMA(&htim, channel);
+        TimRouter::detach(htim, TimRouter::eventCapture, channel);
+        if (hasDuty()) {
+            HAL_TIM_IC_Stop_DMA(&htim, dutyChannel);
+            TimRouter::detach(htim, TimRouter::eventCapture, dutyChannel);
+        }
+    }
+
+    /// consume the captures since the last call and measure over them
+    Measurement measure() {
+        Measurement res = {};
+        uint64_t modulus = uint64_t(htim.Instance->ARR) + 1;
+        uint16_t head, dutyHead = dutyTail;
+
+        // the laps, the write positions and the newest capture have to be read together
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t written = this->written(channel, laps, head);
+        uint32_t dutyWritten = hasDuty() ? this->written(dutyChannel, dutyLaps, dutyHead) : dutyConsumed;
+        uint32_t capture = buffer[head == 0 ? len - 1 : head - 1];
+        uint32_t captureOverflows = resetMode ? 0 : edgeOverflows(written, capture);
+        __set_PRIMASK(primask);
+
+        uint32_t available = written - consumed;
+        uint32_t dutyAvailable = dutyWritten - dutyConsumed;
+        if (available >= len)
+            res.overrun = available;
+
+        tail = head;
+        consumed = written;
+        dutyTail = dutyHead;
+        dutyConsumed = dutyWritten;
+
+        if (available == 0)
+            return res;
+
+        uint64_t sum = 0;
+        if (!resetMode) {
+            // the periods between the last capture of the previous window and the newest one
+            if (hasLastCapture) {
+                sum = uint64_t(captureOverflows - lastOverflows) * modulus + capture - lastCapture;
+                timestamp += sum;
+                res.edges = available;
+            } else {
+                timestamp = uint64_t(captureOverflows) * modulus + capture;
+            }
+
+            lastCapture = capture;
+            lastOverflows = captureOverflows;
+            hasLastCapture = true;
+        } else if (res.overrun == 0) {
+            for (uint16_t i = start(head, available); i != head; i = next(i))
+                sum += buffer[i];
+            res.edges = available;
+        }
+
+        if (res.edges == 0)
+            return res;
+
+        res.period = float(sum) / float(res.edges);
+        res.frequency = float(clock) / float(htim.Instance->PSC + 1) / res.period;
+
+        if (resetMode && dutyAvailable > 0 && dutyAvailable < len) {
+            uint64_t high = 0;
+            for (uint16_t i = start(dutyHead, dutyAvailable); i != dutyHead; i = next(i))
+                high += dutyBuffer[i];
+            res.duty = float(high) / float(dutyAvailable) / res.period;
+        }
+
+        return res;
+    }
+
+    /// count an overflow and mark the edges before it, routed from the TIMx update interrupt by TimRouter
+    void updateCallback() {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint16_t head;
+        uint32_t w = written(channel, laps, head);
+        uint32_t counter = htim.Instance->CNT;
+        if (w != markWritten) {
+            markWritten = w;
+            markOverflows = overflows;
+            markCounter = counter;
+        }
+        overflows = overflows + 1;
+        __set_PRIMASK(primask);
+    }
+
+private:
+    DMA_HandleTypeDef* dma(uint32_t ch) const { return htim.hdma[TIM_DMA_ID_CC1 + (ch >> 2)]; }
+
+    bool hasDuty() const { return dutyBuffer != nullptr && resetMode; }
+
+    uint16_t writeIndex(uint32_t ch) const {
+        uint32_t remaining = __HAL_DMA_GET_COUNTER(dma(ch));
+        return remaining >= len ? 0 : uint16_t(len - remaining);
+    }
+
+    /// edges written by the DMA modulo 2^32, a transfer complete whose interrupt is pending counts as a lap.
+    /// call with interrupts masked
+    uint32_t written(uint32_t ch, uint32_t lapCount, uint16_t& head) const {
+        auto hdma = dma(ch);
+        bool wrapped = __HAL_DMA_GET_FLAG(hdma, __HAL_DMA_GET_TC_FLAG_INDEX(hdma));
+        head = writeIndex(ch);
+        if (!wrapped && __HAL_DMA_GET_FLAG(hdma, __HAL_DMA_GET_TC_FLAG_INDEX(hdma))) {
+            // wrapped between the two reads
+            wrapped = true;
+            head = writeIndex(ch);
+        }
+        return (lapCount + wrapped) * len + head;
+    }
+
+    /// counter overflows before the newest edge, call with interrupts masked
+    uint32_t edgeOverflows(uint32_t written, uint32_t capture) const {
+        if (written == markWritten)
+            return markOverflows + (capture <= markCounter ? 1 : 0);
+
+        // captured after the last update interrupt, or after an overflow whose interrupt is pending
+        bool pending = __HAL_TIM_GET_FLAG(&htim, TIM_FLAG_UPDATE);
+        return overflows + (pending && capture <= htim.Instance->CNT ? 1 : 0);
+    }
+
+    uint16_t next(uint16_t index) const { return index + 1 == len ? 0 : index + 1; }
+
+    /// index of the oldest of n < len captures ending before head
+    uint16_t start(uint16_t head, uint32_t n) const { return head >= n ? uint16_t(head - n) : uint16_t(head + len - n); }
+};
+
+#endif // HAL_TIM_MODULE_ENABLED
+#endif // PERIPH_INPUT_CAPTURE_RING_H
@@ -0,0 +1,139 @@
+#ifndef PERIPH_INVERTER_H
+#define PERIPH_INVERTER_H
+
+#include "main.h"
+#ifdef HAL_TIM_MODULE_ENABLED
+
+#include "periph/pwm_group.h"
+#include "periph/tim_router.h"
+#include "periph/foc.h"
+#include "etl/function.h"
+
+namespace Project::periph { struct Inverter; }
+
+/// 3 phase inverter on an advanced control timer.
+/// channel 1..3 drive the bridge with complementary outputs in center aligned mode,
+/// channel 4 is the ADC trigger (TRGO = OC4REF)
+/// @note requires: TIM1/TIM8 PWM generation CH1..CH3 with CHxN, CH4 PWM generation no output in PWM mode 1,
+///     TIMx update interrupt routed by TimRouter, ADC external trigger TIMx_TRGO
+struct Project::periph::Inverter {
+    using Callback = etl::Function<void(), void*>;
+
+    TIM_HandleTypeDef &htim;        ///< tim handler generated by cubeMX
+    PWMGroup<3> phases = {htim, {TIM_CHANNEL_1, TIM_CHANNEL_2, TIM_CHANNEL_3}, true};
+    Callback controlCallback = {};  ///< control law, invoked once per PWM period from updateCallback
+    uint32_t cycles = 0;            ///< CPU cycles spent in the last control period
+    uint32_t cyclesMax = 0;         ///< maximum CPU cycles spent in a control period
+
+    Inverter(const Inverter&) = delete;             ///< disable copy constructor
+    Inverter& operator=(const Inverter&) = delete;  ///< disable copy assignment
+
+    /// InitArgs::adcTrigger default, CCR4 = period - 1
+    static constexpr uint32_t adcTriggerLowSide = 0xFFFFFFFF;
+
+    struct InitArgs {
+        uint32_t period;                            ///< TIMx->ARR, PWM frequency = timer clock / (2 * period)
+        uint8_t deadTime = 0;                       ///< BDTR.DTG value, see deadTimeRegister()
+        bool useBreak = false;                      ///< enable break input
+        uint32_t breakPolarity = TIM_BREAKPOLARITY_LOW;
+        uint32_t adcTrigger = adcTriggerLowSide;    ///< TIMx->CCR4, ADC trigger point in the PWM period
+        uint32_t trigger = TIM_TRGO_OC4REF;         ///< TRGO source written to CR2.MMS, TIM_TRGO_OC4REF triggers the ADC at adcTrigger
+        Callback controlCallback = {};
+    };
+
+    /// configure center aligned mode, dead time, break input, ADC trigger, and start the bridge with all phases at 50%.
+    /// only BDTR.DTG, BKE and BKP, and CR2.MMS are written, the off states, lock, automatic output, break filters,
+    /// break 2, TRGO2 and the master/slave mode keep the cubeMX configuration.
+    /// a lock level set before init() may make BDTR read only, configure it with LockLevel off
+    /// @param args
+    ///     - .period TIMx->ARR
+    ///     - .deadTime BDTR.DTG value, default 0
+    ///     - .useBreak enable break input, default false
+    ///     - .breakPolarity TIM_BREAKPOLARITY_LOW (default) or TIM_BREAKPOLARITY_HIGH
+    ///     - .adcTrigger TIMx->CCR4, 1..period. OC4REF is active while CNT < CCR4 and its rising edge, on the way down,
+    ///       is the trigger. default adcTriggerLowSide: period - 1, just after the counter peak, the center of the low side
+    ///       on time. 1 triggers at the underflow, the center of the high side on time. 0 never triggers
+    ///     - .trigger TRGO source, default TIM_TRGO_OC4REF
+    ///     - .controlCallback control law
+    void init(InitArgs args) {
+        if (args.controlCallback) controlCallback = args.controlCallback;
+
+        // center aligned, update event once per period at underflow
+        __HAL_TIM_DISABLE(&htim);
+        htim.Instance->CR1 = (htim.Instance->CR1 & ~(TIM_CR1_CMS | TIM_CR1_DIR)) | TIM_COUNTERMODE_CENTERALIGNED1 | TIM_CR1_ARPE;
+        htim.Instance->ARR = args.period;
+        htim.Instance->RCR = 1;
+        htim.Init.CounterMode = TIM_COUNTERMODE_CENTERALIGNED1;
+        htim.Init.Period = args.period;
+        htim.Init.RepetitionCounter = 1;
+
+        uint32_t bdtr = htim.Instance->BDTR & ~(TIM_BDTR_DTG | TIM_BDTR_BKE | TIM_BDTR_BKP);
+        bdtr |= (args.deadTime & TIM_BDTR_DTG) | (args.useBreak ? TIM_BDTR_BKE : 0u) | (args.breakPolarity & TIM_BDTR_BKP);
+        htim.Instance->BDTR = bdtr;
+
+        htim.Instance->CR2 = (htim.Instance->CR2 & ~TIM_CR2_MMS) | args.trigger;
+        htim.Instance->CCR4 = args.adcTrigger == adcTriggerLowSide ? args.period - 1 : args.adcTrigger;
+
+        #ifdef DWT
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        #endif
+
+        phases.init();
+        phases.set({args.period / 2, args.period / 2, args.period / 2});
+        htim.Instance->EGR = TIM_EGR_UG;
+        phases.start();
+        HAL_TIM_PWM_Start(&htim, TIM_CHANNEL_4);
+        TimRouter::attach(htim, TimRouter::eventUpdate, 0, {+[] (void* self) { static_cast<Inverter*>(self)->updateCallback(); }, this});
+        __HAL_TIM_ENABLE_IT(&htim, TIM_IT_UPDATE);
+    }
+
+    /// stop the bridge, outputs go to their idle state
+    void deinit() {
+        __HAL_TIM_DISABLE_IT(&htim, TIM_IT_UPDATE);
+        TimRouter::detach(htim, TimRouter::eventUpdate, 0);
+        HAL_TIM_PWM_Stop(&htim, TIM_CHANNEL_4);
+        phases.stop();
+    }
+
+    /// invoke the control law and measure its execution time, routed from the TIMx update interrupt by TimRouter
+    void updateCallback() {
+        #ifdef DWT
+        uint32_t start = DWT->CYCCNT;
+        controlCallback();
+        cycles = DWT->CYCCNT - start;
+        if (cycles > cyclesMax) cyclesMax = cycles;
+        #else
+        controlCallback();
+        #endif
+    }
+
+    /// apply a voltage vector in the rotating frame
+    /// @param v d and q voltage normalized to the DC bus voltage (Q15), linear up to 1/sqrt(3)
+    /// @param angle electrical angle, 65536 = one turn
+    void modulate(foc::DQ v, uint16_t angle) {
+        modulate(foc::inversePark(v, foc::sinCos(angle)));
+    }
+
+    /// apply a voltage vector in the stationary frame
+    /// @param v alpha and beta voltage normalized to the DC bus voltage (Q15), linear up to 1/sqrt(3)
+    void modulate(foc::AlphaBeta v) {
+        auto duty = foc::svpwm(v, htim.Instance->ARR);
+        phases.set({uint32_t(duty.a), uint32_t(duty.b), uint32_t(duty.c)});
+    }
+
+    /// BDTR.DTG value of a dead time
+    /// @param ns dead time in nanoseconds
+    /// @param clockHz timer kernel clock, with clock division 1
+    static uint8_t deadTimeRegister(uint32_t ns, uint32_t clockHz) {
+        uint32_t ticks = uint32_t((uint64_t(ns) * clockHz + 999999999u) / 1000000000u);
+        if (ticks <= 127) return uint8_t(ticks);
+        if (ticks <= 2 * (64 + 63)) return uint8_t(0x80 | ((ticks + 1) / 2 - 64));
+        if (ticks <= 8 * (32 + 31)) return uint8_t(0xC0 | ((ticks + 7) / 8 - 32));
+        if (ticks <= 16 * (32 + 31)) return uint8_t(0xE0 | ((ticks + 15) / 16 - 32));
+        return 0xFF;
+    }
+};
+
+#endif // HAL_TIM_MODULE_ENABLED
+#endif // PERIPH_INVERTER_H
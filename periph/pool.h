@@ -0,0 +1,86 @@
+#ifndef PERIPH_POOL_H
+#define PERIPH_POOL_H
+
+#include "periph/ring.h"
+
+namespace Project::periph { template <typename T, size_t N> struct Pool; }
+
+/// lock-free pool of fixed size blocks, e.g. received frames handed from an interrupt to a task.
+/// free blocks form a stack whose top carries a 16 bit tag against ABA,
+/// blocks never allocated are taken in order so a zero initialized pool is full
+/// @tparam T trivially copyable block type
+/// @tparam N number of blocks, less than 65535
+template <typename T, size_t N>
+struct Project::periph::Pool {
+    static_assert(N > 0 && N < 0xFFFF, "pool size must be 1..65534");
+    static constexpr size_t capacity = N;
+
+    T blocks[N];
+    std::atomic<uint16_t> links[N];     ///< index + 1 of the next free block
+    std::atomic<uint32_t> top;          ///< tag << 16 | index + 1 of the first free block, 0 if the stack is empty
+    std::atomic<uint32_t> fresh;        ///< number of blocks taken from the never allocated range
+    std::atomic<uint32_t> used;         ///< blocks allocated
+    volatile uint32_t highWater;        ///< maximum number of blocks allocated at once
+    volatile uint32_t exhausted;        ///< counts allocate() calls that found no free block
+
+    /// take a block, may be called from interrupt context
+    /// @retval nullptr if the pool is exhausted
+    [[nodiscard]]
+    T* allocate() {
+        uint32_t old = top.load(std::memory_order_acquire);
+        while ((old & 0xFFFF) != 0) {
+            uint32_t index = (old & 0xFFFF) - 1;
+            uint32_t next = (((old >> 16) + 1) << 16) | links[index].load(std::memory_order_relaxed);
+            if (detail::ringCompareExchange(top, old, next)) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return taken(index);
+            }
+        }
+
+        uint32_t index = fresh.load(std::memory_order_relaxed);
+        while (index < N) {
+            if (detail::ringCompareExchange(fresh, index, index + 1))
+                return taken(index);
+        }
+
+        exhausted = exhausted + 1;
+        return nullptr;
+    }
+
+    /// give a block back, may be called from interrupt context
+    /// @param block block returned by allocate()
+    void release(T* block) {
+        auto index = uint32_t(block - blocks);
+        uint32_t old = top.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        do {
+            links[index].store(uint16_t(old & 0xFFFF), std::memory_order_relaxed);
+        } while (!detail::ringCompareExchange(top, old, (((old >> 16) + 1) << 16) | (index + 1)));
+
+        add(uint32_t(-1));
+    }
+
+    /// number of blocks allocated
+    [[nodiscard]]
+    size_t size() const { return used.load(std::memory_order_relaxed); }
+
+    /// true if the block belongs to this pool
+    [[nodiscard]]
+    bool owns(const T* block) const { return block >= blocks && block < blocks + N; }
+
+private:
+    T* taken(uint32_t index) {
+        uint32_t n = add(1);
+        if (n > highWater)
+            highWater = n;
+        return &blocks[index];
+    }
+
+    uint32_t add(uint32_t delta) {
+        uint32_t old = used.load(std::memory_order_relaxed);
+        while (!detail::ringCompareExchange(used, old, old + delta));
+        return old + delta;
+    }
+};
+
+#endif // PERIPH_POOL_H
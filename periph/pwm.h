@@ -6,6 +6,7 @@
 #ifdef HAL_TIM_MODULE_ENABLED
 
 #include "periph/config.h"
+#include "periph/tim_router.h"
 #include "Core/Inc/tim.h"
 #include "etl/function.h"
 #include "etl/getter_setter.h"
@@ -28,28 +29,49 @@ struct Project::periph::PWM {
     bool useOutputCompare = false;
     Callback fullCallback = {};
     Callback halfCallback = {};
+    bool isDma = false;             ///< started with a DMA buffer
 
     PWM(const PWM&) = delete;               ///< disable copy constructor
     PWM& operator=(const PWM&) = delete;    ///< disable copy assignment
 
     /// register this instance
     void init() {
+        TimRouter::attach(htim, TimRouter::eventPulse, channel, {+[] (void* self) { static_cast<PWM*>(self)->fullCallback(); }, this});
+        TimRouter::attach(htim, TimRouter::eventPulseHalf, channel, {+[] (void* self) { static_cast<PWM*>(self)->halfCallback(); }, this});
         Instances.push(this);
     }
 
-    struct InitArgs { Callback fullCallback = {}, halfCallback = {}; bool startNow = false; };
+    struct InitArgs {
+        Callback fullCallback = {}, halfCallback = {};
+        bool startNow = false;
+        #if defined(PERIPH_PWM_USE_DMA) || defined(PERIPH_PWM_USE_AUTO)
+        uint32_t* dmaBuffer = nullptr;
+        uint16_t len = 0;
+        #endif
+    };
 
-    /// setup prescaler, period, and pulse, and register this instance
+    /// set the callbacks, register this instance, and optionally start
     /// @param args
-    ///     - .prescaler set TIMx->PSC
-    ///     - .period set TIMx->ARR
-    ///     - .pulse set TIMx->CCRchannel
-    ///     - .pulse set TIMx->CCRchannel
+    ///     - .fullCallback invoked at each pulse, or when the DMA has read the whole buffer
+    ///     - .halfCallback invoked when the DMA has read the first half of the buffer
+    ///     - .startNow start pwm, with DMA if .dmaBuffer is given, otherwise with interrupt.
+    ///       with PERIPH_PWM_USE_DMA nothing is started without .dmaBuffer
+    ///     - .dmaBuffer compare values loaded at each period, see start(dmaBuffer, len)
+    ///     - .len number of compare values
     void init(InitArgs args) {
         if (args.fullCallback) fullCallback = args.fullCallback;
         if (args.halfCallback) halfCallback = args.halfCallback;
         init();
-        if (args.startNow) start();
+        if (!args.startNow)
+            return;
+
+        #if defined(PERIPH_PWM_USE_DMA) || defined(PERIPH_PWM_USE_AUTO)
+        if (args.dmaBuffer != nullptr && start(args.dmaBuffer, args.len) == HAL_OK)
+            return;
+        #endif
+        #if defined(PERIPH_PWM_USE_IT) || defined(PERIPH_PWM_USE_AUTO)
+        start();
+        #endif
     }
 
     /// stop pwm and unregister this instance
@@ -57,17 +79,15 @@ struct Project::periph::PWM {
         fullCallback = Callback();
         halfCallback = Callback();
         stop(); 
+        TimRouter::detach(htim, TimRouter::eventPulse, channel);
+        TimRouter::detach(htim, TimRouter::eventPulseHalf, channel);
         Instances.pop(this);
     }
 
+    #if defined(PERIPH_PWM_USE_IT) || defined(PERIPH_PWM_USE_AUTO)
     /// start pwm interrupt
-    void start(
-        #ifdef PERIPH_PWM_USE_DMA
-        uint32_t* dmaBuffer, uint16_t len,
-        uint32_t* dmaBufferInverseChannel = nullptr, uint16_t lenInverseChannel = 0
-        #endif
-    ) { 
-        #ifdef PERIPH_PWM_USE_IT
+    void start() { 
+        isDma = false;
         if (useOutputCompare) {
             HAL_TIM_OC_Start_IT(&htim, channel);
             if (hasInverseChannel)
@@ -77,25 +97,44 @@ struct Project::periph::PWM {
             if (hasInverseChannel)
                 HAL_TIMEx_PWMN_Start_IT(&htim, channel);
         }
+    }
+    #endif
+
+    #if defined(PERIPH_PWM_USE_DMA) || defined(PERIPH_PWM_USE_AUTO)
+    /// start pwm DMA, a compare value of the buffer is loaded at each period
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h), HAL_ERROR with PERIPH_PWM_USE_AUTO if the channel has no DMA request
+    int start(uint32_t* dmaBuffer, uint16_t len, uint32_t* dmaBufferInverseChannel = nullptr, uint16_t lenInverseChannel = 0) {
+        #ifdef PERIPH_PWM_USE_AUTO
+        if (!registry::useDma(htim.Instance, channel, registry::dmaTx, htim.hdma[TIM_DMA_ID_CC1 + (channel >> 2)]))
+            return HAL_ERROR;
         #endif
 
-        #ifdef PERIPH_PWM_USE_DMA
+        int res;
+        isDma = true;
         if (useOutputCompare) {
-            HAL_TIM_OC_Start_DMA(&htim, channel, dmaBuffer, len);
+            res = HAL_TIM_OC_Start_DMA(&htim, channel, dmaBuffer, len);
             if (hasInverseChannel)
                 HAL_TIMEx_OCN_Start_DMA(&htim, channel, dmaBufferInverseChannel, lenInverseChannel);
         } else {
-            HAL_TIM_PWM_Start_DMA(&htim, channel, dmaBuffer, len);
+            res = HAL_TIM_PWM_Start_DMA(&htim, channel, dmaBuffer, len);
             if (hasInverseChannel)
                 HAL_TIMEx_PWMN_Start_DMA(&htim, channel, dmaBufferInverseChannel, lenInverseChannel);
         }
-        #endif
+        return res;
     }
+    #endif
 
-    /// stop pwm interrupt
+    /// stop pwm
     void stop() { 
-        #ifdef PERIPH_PWM_USE_IT
-        if (useOutputCompare) {
+        if (isDma && useOutputCompare) {
+            HAL_TIM_OC_Stop_DMA(&htim, channel);
+            if (hasInverseChannel)
+                HAL_TIMEx_OCN_Stop_DMA(&htim, channel);
+        } else if (isDma) {
+            HAL_TIM_PWM_Stop_DMA(&htim, channel);
+            if (hasInverseChannel)
+                HAL_TIMEx_PWMN_Stop_DMA(&htim, channel);
+        } else if (useOutputCompare) {
             HAL_TIM_OC_Stop_IT(&htim, channel);
             if (hasInverseChannel)
                 HAL_TIMEx_OCN_Stop_IT(&htim, channel);
@@ -104,19 +143,6 @@ struct Project::periph::PWM {
             if (hasInverseChannel)
                 HAL_TIMEx_PWMN_Stop_IT(&htim, channel);
         }
-        #endif
-
-        #ifdef PERIPH_PWM_USE_DMA
-        if (useOutputCompare) {
-            HAL_TIM_OC_Stop_DMA(&htim, channel);
-            if (hasInverseChannel)
-                HAL_TIMEx_OCN_Stop_DMA(&htim, channel);
-        } else {
-            HAL_TIM_PWM_Stop_DMA(&htim, channel);
-            if (hasInverseChannel)
-                HAL_TIMEx_PWMN_Stop_DMA(&htim, channel);
-        }
-        #endif
     }
 
     /// TIMx->CCR
@@ -0,0 +1,105 @@
+#ifndef PERIPH_PWM_GROUP_H
+#define PERIPH_PWM_GROUP_H
+
+#include "main.h"
+#ifdef HAL_TIM_MODULE_ENABLED
+
+#include "periph/config.h"
+#include "Core/Inc/tim.h"
+
+namespace Project::periph { template <size_t N> struct PWMGroup; }
+
+/// PWM channels of one timer updated together at the next update event.
+/// compare registers are preloaded, so new pulses take effect at the same update event
+/// @note requires: TIMx PWM generation mode, TIMx update DMA for burst update
+template <size_t N>
+struct Project::periph::PWMGroup {
+    static_assert(N > 0 && N <= 4, "PWM group supports channel 1 to 4");
+
+    TIM_HandleTypeDef &htim;        ///< tim handler generated by cubeMX
+    uint32_t channels[N];           ///< TIM_CHANNEL_x
+    bool hasInverseChannel = false;
+    volatile uint32_t* ccr[N] = {}; ///< compare register of each channel
+
+    PWMGroup(const PWMGroup&) = delete;             ///< disable copy constructor
+    PWMGroup& operator=(const PWMGroup&) = delete;  ///< disable copy assignment
+
+    /// resolve compare registers and enable compare preload of each channel
+    void init() {
+        for (size_t i = 0; i < N; ++i) {
+            uint32_t index = channels[i] >> 2;
+            ccr[i] = &htim.Instance->CCR1 + index;
+            (&htim.Instance->CCMR1)[index >> 1] |= TIM_CCMR1_OC1PE << ((index & 1) * 8);
+        }
+    }
+
+    struct InitArgs { bool startNow = false; };
+
+    void init(InitArgs args) {
+        init();
+        if (args.startNow) start();
+    }
+
+    /// stop pwm, burst update has to be stopped with stopBurst()
+    void deinit() {
+        stop();
+    }
+
+    /// start pwm of all channels
+    void start() {
+        for (auto channel : channels) {
+            HAL_TIM_PWM_Start(&htim, channel);
+            if (hasInverseChannel)
+                HAL_TIMEx_PWMN_Start(&htim, channel);
+        }
+    }
+
+    /// stop pwm of all channels
+    void stop() {
+        for (auto channel : channels) {
+            HAL_TIM_PWM_Stop(&htim, channel);
+            if (hasInverseChannel)
+                HAL_TIMEx_PWMN_Stop(&htim, channel);
+        }
+    }
+
+    /// set pulse of all channels, all of them take effect at the same update event
+    /// @param pulses TIMx->CCR value of each channel, in the order of channels
+    void set(const uint32_t (&pulses)[N]) {
+        htim.Instance->CR1 |= TIM_CR1_UDIS;
+        for (size_t i = 0; i < N; ++i)
+            *ccr[i] = pulses[i];
+        htim.Instance->CR1 &= ~TIM_CR1_UDIS;
+    }
+
+    /// get current pulse of a channel
+    /// @param index index in channels
+    [[nodiscard]]
+    uint32_t get(size_t index) const { return *ccr[index]; }
+
+    /// start DMA burst update: at every update event the timer DMA writes the compare registers
+    /// from the first to the last channel of the group in one burst
+    /// @param buffer CCR values of consecutive channels starting from the lowest channel of the group,
+    ///     must stay valid until stopBurst(). With circular DMA, writes to buffer are picked up at the next update event
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
+    int startBurst(const uint32_t* buffer) {
+        uint32_t first = 3, last = 0;
+        for (auto channel : channels) {
+            uint32_t index = channel >> 2;
+            if (index < first) first = index;
+            if (index > last) last = index;
+        }
+
+        return HAL_TIM_DMABurst_WriteStart(&htim, TIM_DMABASE_CCR1 + first, TIM_DMA_UPDATE,
+                                           const_cast<uint32_t*>(buffer), (last - first) << 8);
+    }
+
+    /// stop DMA burst update
+    /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
+    int stopBurst() {
+        return HAL_TIM_DMABurst_WriteStop(&htim, TIM_DMA_UPDATE);
+    }
+};
+
+#endif // HAL_TIM_MODULE_ENABLED
+#endif // PERIPH_PWM_GROUP_H
@@ -0,0 +1,126 @@
+#ifndef PERIPH_PWM_STREAM_H
+#define PERIPH_PWM_STREAM_H
+
+#include "main.h"
+#ifdef HAL_TIM_MODULE_ENABLED
+
+#include "periph/pwm.h"
+#if defined(PERIPH_PWM_USE_DMA) || defined(PERIPH_PWM_USE_AUTO)
+
+namespace Project::periph { struct PWMStream; struct PWMBitEncoder; }
+
+/// encode bytes MSB first into one compare value per bit, e.g. WS2812 or DShot frames
+struct Project::periph::PWMBitEncoder {
+    const uint8_t* data = nullptr;  ///< bytes to encode
+    size_t len = 0;                 ///< number of bytes
+    uint32_t pulse0 = 0;            ///< compare value of bit 0
+    uint32_t pulse1 = 0;            ///< compare value of bit 1
+    size_t bit = 0;                 ///< number of bits encoded so far
+
+    /// encode the next bits
+    /// @param out[out] compare values
+    /// @param n maximum number of compare values
+    /// @retval number of compare values written, less than n at the end of data
+    size_t operator()(uint32_t* out, size_t n) {
+        size_t total = len * 8;
+        size_t i = 0;
+        for (; i < n && bit < total; ++i, ++bit)
+            out[i] = (data[bit >> 3] & (0x80u >> (bit & 7))) ? pulse1 : pulse0;
+        return i;
+    }
+};
+
+/// stream compare values through a small circular DMA buffer.
+/// each half of the buffer is refilled by the source from halfCallback and fullCallback of the PWM,
+/// the output is held at idlePulse once the source is exhausted, and stopped after a whole idle half
+/// @note requires: PERIPH_PWM_USE_DMA or PERIPH_PWM_USE_AUTO, TIMx CCx DMA in circular mode, word transfers
+struct Project::periph::PWMStream {
+    using Source = etl::Function<size_t(uint32_t*, size_t), void*>;   ///< fills compare values, returns how many were written
+    using Callback = PWM::Callback;
+
+    PWM& pwm;                       ///< PWM channel
+    uint32_t* buffer;               ///< circular DMA buffer
+    size_t len;                     ///< buffer length, even
+    uint32_t idlePulse = 0;         ///< compare value after the end of the stream, e.g. 0 for WS2812 reset
+    Callback doneCallback = {};     ///< invoked when the stream has been shifted out completely
+
+    Source source = {};
+    volatile bool isBusy = false;
+    bool exhausted = false;
+    bool loaded[2] = {};
+
+    PWMStream(const PWMStream&) = delete;               ///< disable copy constructor
+    PWMStream& operator=(const PWMStream&) = delete;    ///< disable copy assignment
+
+    /// start streaming
+    /// @param src compare value source, invoked from interrupt context
+    /// @retval false if a stream is in progress
+    bool start(Source src) {
+        if (isBusy)
+            return false;
+
+        source = src;
+        isBusy = true;
+        exhausted = false;
+        pwm.halfCallback = {+[] (void* self) { static_cast<PWMStream*>(self)->refill(0); }, this};
+        pwm.fullCallback = {+[] (void* self) { static_cast<PWMStream*>(self)->refill(1); }, this};
+        fill(0);
+        fill(1);
+
+        pwm.init();
+        if (pwm.start(buffer, uint16_t(len)) != HAL_OK) {
+            stop();
+            return false;
+        }
+        return true;
+    }
+
+    /// start streaming bytes MSB first
+    /// @param encoder bit encoder, must stay valid until the stream is done
+    bool start(PWMBitEncoder& encoder) {
+        // the encoder may be the one of the stream in progress
+        if (isBusy)
+            return false;
+
+        encoder.bit = 0;
+        return start(Source{+[] (void* enc, uint32_t* out, size_t n) {
+            return (*static_cast<PWMBitEncoder*>(enc))(out, n);
+        }, &encoder});
+    }
+
+    /// abort streaming, the PWM is stopped and unregistered
+    void stop() {
+        pwm.deinit();
+        isBusy = false;
+    }
+
+private:
+    /// fill one half of the buffer from the source, pad with idlePulse
+    void fill(size_t half) {
+        size_t n = len / 2;
+        uint32_t* out = buffer + half * n;
+        size_t written = exhausted ? 0 : source(out, n);
+        if (written < n)
+            exhausted = true;
+
+        for (size_t i = written; i < n; ++i)
+            out[i] = idlePulse;
+        loaded[half] = written > 0;
+    }
+
+    /// the DMA has finished reading one half
+    void refill(size_t half) {
+        // a whole idle half has been read: the last compare value has been shifted out
+        if (!loaded[half]) {
+            stop();
+            doneCallback();
+            return;
+        }
+
+        fill(half);
+    }
+};
+
+#endif // PERIPH_PWM_USE_DMA || PERIPH_PWM_USE_AUTO
+#endif // HAL_TIM_MODULE_ENABLED
+#endif // PERIPH_PWM_STREAM_H
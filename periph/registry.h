@@ -0,0 +1,165 @@
+#ifndef PERIPH_REGISTRY_H
+#define PERIPH_REGISTRY_H
+
+#include "main.h"
+#include <cstddef>
+#include <cstdint>
+
+/// peripherals enabled in the cubeMX project, generated at configure time by generate_periph_registry() in cmake/ioc_parser.cmake.
+/// each kind (Uart, Can, Tim, Adc, I2s, I2c) lists its instances in .ioc order with their interrupts and DMA requests,
+/// index() maps a peripheral base address to its position with a switch the compiler turns into a jump table or a few compares.
+/// the drivers keep their instances in Slots indexed by it instead of scanning a list in each interrupt.
+/// without PERIPH_USE_REGISTRY only the flags and useDma() are available
+/// @example
+///     static_assert(registry::has<registry::Uart>(USART2_BASE, registry::irqGlobal, registry::dmaRx), "USART2 needs rx DMA");
+namespace Project::periph::registry {
+    /// enabled NVIC lines of a peripheral
+    enum : uint32_t {
+        irqGlobal   = 1u << 0,
+        irqRx0      = 1u << 1,
+        irqRx1      = 1u << 2,
+        irqTx       = 1u << 3,
+        irqSce      = 1u << 4,
+        irqEvent    = 1u << 5,
+        irqError    = 1u << 6,
+        irqCapture  = 1u << 7,
+        irqUpdate   = 1u << 8,
+        irqTrigger  = 1u << 9,
+        irqBreak    = 1u << 10,
+    };
+
+    /// DMA requests of a peripheral
+    enum : uint32_t {
+        dmaRx           = 1u << 0,  ///< peripheral to memory
+        dmaRxCircular   = 1u << 1,
+        dmaTx           = 1u << 2,  ///< memory to peripheral
+        dmaTxCircular   = 1u << 3,
+        dmaUpdate       = 1u << 4,  ///< TIMx_UP
+        dmaTrigger      = 1u << 5,  ///< TIMx_TRIG
+    };
+
+    /// timer channel function
+    enum : uint8_t { modeOther, modePwm, modeCapture, modeCompare };
+
+    struct Entry {
+        const char* name;   ///< cubeMX name, e.g. USART1 or I2S2
+        uintptr_t base;     ///< HAL instance base address, e.g. SPI2_BASE for I2S2
+        uint32_t irq;
+        uint32_t dma;
+        uint32_t size;      ///< buffer size in elements, number of regular conversions of an ADC, 0 if unknown
+    };
+
+    struct TimChannel {
+        const char* name;
+        uintptr_t base;
+        uint32_t channel;   ///< TIM_CHANNEL_x
+        uint8_t mode;
+        uint32_t dma;       ///< dmaRx or dmaTx of the TIMx_CHx request
+    };
+}
+
+#ifdef PERIPH_USE_REGISTRY
+#include "periph/ioc_registry.h"
+
+namespace Project::periph::registry {
+    /// true if the peripheral is in the registry with all the given interrupts and DMA requests
+    template <typename Kind>
+    constexpr bool has(uintptr_t base, uint32_t irq = 0, uint32_t dma = 0) {
+        int i = Kind::index(base);
+        return i >= 0 && (Kind::entries[i].irq & irq) == irq && (Kind::entries[i].dma & dma) == dma;
+    }
+
+    /// true if at least one peripheral of a kind has all the given interrupts and DMA requests
+    template <typename Kind>
+    constexpr bool any(uint32_t irq, uint32_t dma) {
+        for (size_t i = 0; i < Kind::count; ++i)
+            if ((Kind::entries[i].irq & irq) == irq && (Kind::entries[i].dma & dma) == dma)
+                return true;
+        return false;
+    }
+
+    /// true if at least one timer channel of the given mode has all the given DMA requests
+    constexpr bool anyChannel(uint8_t mode, uint32_t dma) {
+        for (size_t i = 0; i < TimChannels::count; ++i)
+            if (TimChannels::entries[i].mode == mode && (TimChannels::entries[i].dma & dma) == dma)
+                return true;
+        return false;
+    }
+
+    /// largest buffer size of a kind
+    template <typename Kind>
+    constexpr uint32_t maxSize() {
+        uint32_t res = 0;
+        for (size_t i = 0; i < Kind::count; ++i)
+            if (Kind::entries[i].size > res)
+                res = Kind::entries[i].size;
+        return res;
+    }
+
+    /// driver instances at the registry position of their peripheral
+    /// @tparam T driver
+    /// @tparam Kind registry kind of the peripheral
+    template <typename T, typename Kind>
+    struct Slots {
+        T* instances[Kind::count > 0 ? Kind::count : 1];
+
+        void bind(const volatile void* peripheral, T* driver) {
+            int i = Kind::index(reinterpret_cast<uintptr_t>(peripheral));
+            if (i >= 0)
+                instances[i] = driver;
+        }
+
+        void unbind(const volatile void* peripheral, T* driver) {
+            int i = Kind::index(reinterpret_cast<uintptr_t>(peripheral));
+            if (i >= 0 && instances[i] == driver)
+                instances[i] = nullptr;
+        }
+
+        /// driver of a peripheral, nullptr if none is bound
+        [[nodiscard]]
+        T* find(const volatile void* peripheral) const {
+            int i = Kind::index(reinterpret_cast<uintptr_t>(peripheral));
+            return i < 0 ? nullptr : instances[i];
+        }
+    };
+}
+
+#else
+namespace Project::periph::registry { struct Uart; struct Can; struct Tim; struct Adc; struct I2s; struct I2c; }
+#endif // PERIPH_USE_REGISTRY
+
+namespace Project::periph::registry {
+    /// transfer mode of an instance with PERIPH_xxx_USE_AUTO: DMA if the .ioc has the request,
+    /// or without the registry, if cubeMX has linked a DMA handle to the peripheral handle
+    /// @param peripheral HAL instance, e.g. huart.Instance
+    /// @param dma dmaRx or dmaTx
+    /// @param hdma DMA handle linked by cubeMX, e.g. huart.hdmarx
+    template <typename Kind>
+    bool useDma([[maybe_unused]] const volatile void* peripheral, [[maybe_unused]] uint32_t dma, [[maybe_unused]] const void* hdma) {
+        #ifdef PERIPH_USE_REGISTRY
+        return has<Kind>(reinterpret_cast<uintptr_t>(peripheral), 0, dma);
+        #else
+        return hdma != nullptr;
+        #endif
+    }
+
+    /// transfer mode of a timer channel with PERIPH_xxx_USE_AUTO
+    /// @param peripheral TIMx
+    /// @param channel TIM_CHANNEL_x
+    /// @param dma dmaRx for input capture or dmaTx for PWM and output compare
+    /// @param hdma DMA handle of the channel linked by cubeMX, e.g. htim.hdma[TIM_DMA_ID_CC1]
+    inline bool useDma([[maybe_unused]] const volatile void* peripheral, [[maybe_unused]] uint32_t channel,
+                       [[maybe_unused]] uint32_t dma, [[maybe_unused]] const void* hdma) {
+        #ifdef PERIPH_USE_REGISTRY
+        auto base = reinterpret_cast<uintptr_t>(peripheral);
+        for (auto& entry : TimChannels::entries)
+            if (entry.base == base && entry.channel == channel)
+                return (entry.dma & dma) == dma;
+        return false;
+        #else
+        return hdma != nullptr;
+        #endif
+    }
+}
+
+#endif // PERIPH_REGISTRY_H
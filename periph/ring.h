@@ -0,0 +1,248 @@
+#ifndef PERIPH_RING_H
+#define PERIPH_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_8M_BASE__)
+#include "main.h" // no exclusive access instructions, compare and swap masks interrupts
+#endif
+
+namespace Project::periph {
+    template <typename T> struct RingSpan;
+    template <typename T, size_t N> struct SpscRing;
+    template <typename T, size_t N> struct MpscRing;
+}
+
+/// contiguous part of a ring
+template <typename T>
+struct Project::periph::RingSpan {
+    T* data;
+    size_t len;
+};
+
+namespace Project::periph::detail {
+    inline bool ringCompareExchange(std::atomic<uint32_t>& value, uint32_t& expected, uint32_t desired) {
+        #if defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_8M_BASE__)
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t current = value.load(std::memory_order_relaxed);
+        bool res = current == expected;
+        if (res)
+            value.store(desired, std::memory_order_relaxed);
+        else
+            expected = current;
+        __set_PRIMASK(primask);
+        return res;
+        #else
+        return value.compare_exchange_weak(expected, desired, std::memory_order_relaxed, std::memory_order_relaxed);
+        #endif
+    }
+}
+
+/// single producer single consumer ring, e.g. a task and an interrupt.
+/// indices are free running, a zero initialized ring is empty
+/// @tparam T trivially copyable element
+/// @tparam N capacity, power of two
+template <typename T, size_t N>
+struct Project::periph::SpscRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "ring size must be a power of two");
+    static constexpr size_t capacity = N;
+    static constexpr uint32_t mask = N - 1;
+
+    T buffer[N];
+    std::atomic<uint32_t> head;     ///< elements pushed, written by the producer
+    std::atomic<uint32_t> tail;     ///< elements popped, written by the consumer
+
+    /// number of elements waiting
+    [[nodiscard]]
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+    /// number of elements that can be pushed
+    [[nodiscard]]
+    size_t free() const { return N - size(); }
+
+    [[nodiscard]]
+    bool isEmpty() const { return size() == 0; }
+
+    /// producer: push one element
+    /// @retval false if the ring is full
+    bool push(const T& value) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N)
+            return false;
+
+        buffer[h & mask] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// producer: push up to n elements
+    /// @retval number of elements pushed
+    size_t push(const T* values, size_t n) {
+        size_t done = 0;
+        for (auto span = writeSpan(); span.len > 0 && done < n; span = writeSpan()) {
+            size_t k = span.len < n - done ? span.len : n - done;
+            for (size_t i = 0; i < k; ++i)
+                span.data[i] = values[done + i];
+            commit(k);
+            done += k;
+        }
+        return done;
+    }
+
+    /// producer: free elements up to the end of the buffer, fill them, e.g. by DMA, then commit()
+    [[nodiscard]]
+    RingSpan<T> writeSpan() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        size_t room = N - (h - tail.load(std::memory_order_acquire));
+        size_t contiguous = N - (h & mask);
+        return { buffer + (h & mask), room < contiguous ? room : contiguous };
+    }
+
+    /// producer: publish n elements of writeSpan()
+    void commit(size_t n) { head.store(head.load(std::memory_order_relaxed) + uint32_t(n), std::memory_order_release); }
+
+    /// consumer: pop one element
+    /// @retval false if the ring is empty
+    bool pop(T& value) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t)
+            return false;
+
+        value = buffer[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// consumer: pop up to n elements
+    /// @retval number of elements popped
+    size_t pop(T* values, size_t n) {
+        size_t done = 0;
+        for (auto span = readSpan(); span.len > 0 && done < n; span = readSpan()) {
+            size_t k = span.len < n - done ? span.len : n - done;
+            for (size_t i = 0; i < k; ++i)
+                values[done + i] = span.data[i];
+            release(k);
+            done += k;
+        }
+        return done;
+    }
+
+    /// consumer: waiting elements up to the end of the buffer, valid until release()
+    [[nodiscard]]
+    RingSpan<T> readSpan() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        size_t n = head.load(std::memory_order_acquire) - t;
+        size_t contiguous = N - (t & mask);
+        return { buffer + (t & mask), n < contiguous ? n : contiguous };
+    }
+
+    /// consumer: drop n elements of readSpan()
+    void release(size_t n) { tail.store(tail.load(std::memory_order_relaxed) + uint32_t(n), std::memory_order_release); }
+
+    /// consumer: drop all elements
+    void clear() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+};
+
+/// multiple producer single consumer ring, e.g. interrupts of different priorities and a task.
+/// bounded queue with one sequence number per cell (D. Vyukov), a preempted producer never blocks the others.
+/// sequences are stored relative to the cell index, so a zero initialized ring is empty
+/// @tparam T trivially copyable element
+/// @tparam N capacity, power of two
+template <typename T, size_t N>
+struct Project::periph::MpscRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "ring size must be a power of two");
+    static constexpr size_t capacity = N;
+    static constexpr uint32_t mask = N - 1;
+
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        T value;
+    };
+
+    Cell cells[N];
+    std::atomic<uint32_t> head;     ///< elements reserved by the producers
+    std::atomic<uint32_t> tail;     ///< elements popped, written by the consumer only
+
+    /// approximate number of elements waiting, may be called by the producers
+    [[nodiscard]]
+    size_t size() const {
+        // tail first, it never passes head, and clamp as both may move between the loads
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t n = head.load(std::memory_order_acquire) - t;
+        return n > N ? N : n;
+    }
+
+    /// producer: reserve a cell, fill it in place, and publish it
+    /// @param fill callable taking T&
+    /// @retval false if the ring is full
+    template <typename F>
+    bool emplace(F&& fill) {
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            uint32_t index = pos & mask;
+            auto& cell = cells[index];
+            auto diff = int32_t(cell.sequence.load(std::memory_order_acquire) + index - pos);
+            if (diff == 0) {
+                if (detail::ringCompareExchange(head, pos, pos + 1)) {
+                    fill(cell.value);
+                    cell.sequence.store(pos + 1 - index, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// producer: push one element
+    /// @retval false if the ring is full
+    bool push(const T& value) { return emplace([&value] (T& cell) { cell = value; }); }
+
+    /// consumer: oldest published element, valid until pop()
+    /// @retval nullptr if the ring is empty or the oldest reservation is still being filled
+    [[nodiscard]]
+    T* front() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t index = t & mask;
+        auto& cell = cells[index];
+        if (cell.sequence.load(std::memory_order_acquire) + index != t + 1)
+            return nullptr;
+        return &cell.value;
+    }
+
+    /// consumer: release the element of front()
+    void pop() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t index = t & mask;
+        cells[index].sequence.store(t + N - index, std::memory_order_release);
+        tail.store(t + 1, std::memory_order_relaxed);
+    }
+
+    /// consumer: pop one element
+    /// @retval false if the ring is empty
+    bool pop(T& value) {
+        auto p = front();
+        if (p == nullptr)
+            return false;
+
+        value = *p;
+        pop();
+        return true;
+    }
+
+    /// consumer: pop up to n elements
+    /// @retval number of elements popped
+    size_t pop(T* values, size_t n) {
+        size_t done = 0;
+        while (done < n && pop(values[done]))
+            ++done;
+        return done;
+    }
+};
+
+#endif // PERIPH_RING_H
@@ -11,12 +11,15 @@
 
 namespace Project::periph { class RealTimeClock; }
 
-/// RTC peripheral class
+/// RTC peripheral class.
+/// the RTC is read once, then the time is extrapolated from the system tick and resynchronized every resyncInterval,
+/// so every getter and timestamp comes from one consistent reading without shadow register syncs.
+/// the readings never go backwards: when a resync finds the system tick ran ahead of the RTC,
+/// the time holds at the last returned value until the RTC catches up. only setDate() and setTime() step it back.
+/// update() and the getters may be called from interrupts and tasks
 /// @note requirements: no RTC output
 class Project::periph::RealTimeClock {
     inline static const char days[7][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
-    inline static const auto minimumUpdateInterval = etl::time::milliseconds(500);
-    inline static auto lastUpdate = etl::Time(0);
 
     template <typename T>
     using Getter = etl::Getter<T, etl::Function<T(), RealTimeClock*>>;
@@ -24,21 +27,130 @@ class Project::periph::RealTimeClock {
     RTC_TimeTypeDef sTime = {};
     RTC_DateTypeDef sDate = {};
 
+    int64_t baseMillis = 0;     ///< unix time of the last synchronization in milliseconds
+    uint32_t baseTick = 0;      ///< HAL tick of the last synchronization
+    int64_t lastMillis = 0;     ///< largest unix time returned in milliseconds
+    bool isSynced = false;
+
 public:
+    /// unix time
+    struct Timestamp {
+        int64_t seconds;        ///< seconds since 1970-01-01 00:00:00
+        uint16_t milliseconds;  ///< 0..999
+    };
+
+    /// broken down UTC time
+    struct Calendar {
+        int year, month, date;          ///< e.g. 2024, 1..12, 1..31
+        int hours, minutes, seconds;
+        int weekDay;                    ///< 0 = Sunday
+        int milliseconds;
+    };
+
+    uint32_t resyncInterval = 60000;    ///< milliseconds between two RTC reads
+
     /// default constructor
     constexpr RealTimeClock() = default;
 
     RealTimeClock(const RealTimeClock&) = delete; ///< disable copy constructor
     RealTimeClock& operator=(const RealTimeClock&) = delete;  ///< disable copy assignment
 
-    /// get time and date and store to sTime and sDate
+    /// read the RTC and restart the extrapolation from the current tick.
+    /// the read and the base swap are one critical section, a few register reads long, so an interrupt
+    /// can not split the shadow register lock of HAL_RTC_GetTime and HAL_RTC_GetDate or see a half written base
     void update() {
-        auto now = etl::time::now();
-        if (now - lastUpdate < minimumUpdateInterval) return;
-
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
         HAL_RTC_GetTime(&hrtc, &sTime, RTC_FORMAT_BIN);
-        HAL_RTC_GetDate(&hrtc, &sDate, RTC_FORMAT_BIN);
-        lastUpdate = now;
+        HAL_RTC_GetDate(&hrtc, &sDate, RTC_FORMAT_BIN); // unlocks the shadow registers, must follow HAL_RTC_GetTime
+        uint32_t tick = HAL_GetTick();
+
+        int64_t seconds = daysFromCivil(2000 + sDate.Year, sDate.Month, sDate.Date) * 86400
+            + sTime.Hours * 3600 + sTime.Minutes * 60 + sTime.Seconds;
+        int64_t millis = seconds * 1000;
+        #ifdef RTC_SSR_SS
+        millis += (sTime.SecondFraction - sTime.SubSeconds) * 1000 / (sTime.SecondFraction + 1);
+        #else
+        // no sub-second register (F1): keep the extrapolated milliseconds while they fall in the RTC second,
+        // otherwise take the nearest end of that second, so a resync does not hold the time for up to a second
+        if (isSynced) {
+            int64_t extrapolated = baseMillis + int64_t(tick - baseTick);
+            if (extrapolated >= millis + 1000)
+                millis += 999;
+            else if (extrapolated > millis)
+                millis = extrapolated;
+        }
+        #endif
+
+        baseMillis = millis;
+        baseTick = tick;
+        isSynced = true;
+        __set_PRIMASK(primask);
+    }
+
+    /// unix time in milliseconds, monotonic between two calls of setDate() or setTime()
+    int64_t unixMillis() {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        bool expired = !isSynced || HAL_GetTick() - baseTick >= resyncInterval;
+        __set_PRIMASK(primask);
+
+        if (expired)
+            update();
+
+        __disable_irq();
+        int64_t res = baseMillis + int64_t(HAL_GetTick() - baseTick);
+        if (res < lastMillis)
+            res = lastMillis;
+        else
+            lastMillis = res;
+        __set_PRIMASK(primask);
+        return res;
+    }
+
+    /// unix time
+    Timestamp now() {
+        int64_t ms = unixMillis();
+        return { ms / 1000, uint16_t(ms % 1000) };
+    }
+
+    /// broken down time of now()
+    Calendar calendar() {
+        int64_t ms = unixMillis();
+        int64_t days = ms / 86400000;
+        auto time = int32_t(ms % 86400000);
+
+        Calendar res = {};
+        civilFromDays(days, res.year, res.month, res.date);
+        res.weekDay = int((days + 4) % 7); // 1970-01-01 is a Thursday
+        res.hours = time / 3600000;
+        res.minutes = time / 60000 % 60;
+        res.seconds = time / 1000 % 60;
+        res.milliseconds = time % 1000;
+        return res;
+    }
+
+    /// days since 1970-01-01 of a proleptic gregorian date
+    static constexpr int64_t daysFromCivil(int year, int month, int date) {
+        year -= month <= 2;
+        int era = (year >= 0 ? year : year - 399) / 400;
+        int yoe = year - era * 400;
+        int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + date - 1;
+        int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return int64_t(era) * 146097 + doe - 719468;
+    }
+
+    /// proleptic gregorian date of days since 1970-01-01
+    static constexpr void civilFromDays(int64_t days, int& year, int& month, int& date) {
+        days += 719468;
+        auto era = int((days >= 0 ? days : days - 146096) / 146097);
+        auto doe = int(days - int64_t(era) * 146097);
+        int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int mp = (5 * doy + 2) / 153;
+        date = doy - (153 * mp + 2) / 5 + 1;
+        month = mp < 10 ? mp + 3 : mp - 9;
+        year = yoe + era * 400 + (month <= 2);
     }
 
     struct DateArgs { int weekDay, date, month, year; };
@@ -48,6 +160,7 @@ public:
         sDate.Month = uint8_t(args.month);
         sDate.Year = uint8_t(args.year);
         HAL_RTC_SetDate(&hrtc, &sDate, RTC_FORMAT_BIN);
+        step();
     }
 
     struct TimeArgs { int hours, minutes, seconds; };
@@ -56,6 +169,7 @@ public:
         sTime.Minutes = args.minutes;
         sTime.Seconds = args.seconds;
         HAL_RTC_SetTime(&hrtc, &sTime, RTC_FORMAT_BIN);
+        step();
     }
 
     const Getter<int> seconds   = {etl::bind<&RealTimeClock::getSeconds>(this)};
@@ -68,15 +182,25 @@ public:
     const Getter<const char*> day = {etl::bind<&RealTimeClock::getDay>(this)};
 
 private:
-    int getSeconds()  { update(); return sTime.Seconds; }
-    int getMinutes()  { update(); return sTime.Minutes; }
-    int getHours()    { update(); return sTime.Hours; }
-    int getWeekDay()  { update(); return sDate.WeekDay; }
-    int getDate()     { update(); return sDate.Date; }
-    int getMonth()    { update(); return sDate.Month; }
-    int getYear()     { update(); return sDate.Year; }
-
-    const char* getDay() { update(); return days[sDate.WeekDay]; }
+    /// resync after the RTC was set, the time may go backwards
+    void step() {
+        isSynced = false; // the new time starts at its second, nothing to carry over
+        update();
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        lastMillis = baseMillis;
+        __set_PRIMASK(primask);
+    }
+
+    int getSeconds()  { return calendar().seconds; }
+    int getMinutes()  { return calendar().minutes; }
+    int getHours()    { return calendar().hours; }
+    int getWeekDay()  { return calendar().weekDay; }
+    int getDate()     { return calendar().date; }
+    int getMonth()    { return calendar().month; }
+    int getYear()     { return calendar().year - 2000; }
+
+    const char* getDay() { return days[calendar().weekDay]; }
 };
 
 namespace Project::periph { inline RealTimeClock rtc; }
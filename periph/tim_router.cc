@@ -0,0 +1,103 @@
+#include "periph/tim_router.h"
+
+#ifdef HAL_TIM_MODULE_ENABLED
+
+using namespace Project::periph;
+
+TimRouter::Slot TimRouter::slots[TimRouter::maxTimers];
+uint8_t TimRouter::table[64];
+
+bool TimRouter::attach(TIM_HandleTypeDef& htim, int event, uint32_t channel, Callback callback) {
+    // TIM_CHANNEL_5 and 6 would alias channel 1 and 2 in the handler tables
+    bool perChannel = event == eventCapture || event == eventPulse || event == eventPulseHalf;
+    if (perChannel && (channel >> 2) > 3)
+        return false;
+
+    auto slot = find(htim.Instance);
+    if (slot == nullptr && !callback)
+        return true; // nothing to detach
+
+    if (slot == nullptr) {
+        #ifdef PERIPH_USE_REGISTRY
+        // the slot at the registry position of the timer
+        int i = registry::Tim::index(reinterpret_cast<uintptr_t>(htim.Instance));
+        if (i >= 0) {
+            slot = &slots[i];
+            slot->instance = htim.Instance;
+        }
+        #else
+        // allocate a new slot
+        for (size_t i = 0; i < maxTimers; ++i) {
+            if (slots[i].instance != nullptr)
+                continue;
+
+            slot = &slots[i];
+            slot->instance = htim.Instance;
+            if (table[hash(htim.Instance)] == 0)
+                table[hash(htim.Instance)] = uint8_t(i + 1);
+            break;
+        }
+        #endif
+    }
+
+    if (slot == nullptr)
+        return false;
+
+    uint32_t index = channel >> 2;
+    Callback* handler;
+    switch (event) {
+        case eventCapture: handler = &slot->capture[index]; break;
+        case eventPulse: handler = &slot->pulse[index]; break;
+        case eventPulseHalf: handler = &slot->pulseHalf[index]; break;
+        case eventUpdate: handler = &slot->update; break;
+        case eventTrigger: handler = &slot->trigger; break;
+        default: return false;
+    }
+
+    // taken by another driver, e.g. an InputCapture and an Encoder on the same channel
+    if (callback && *handler)
+        return false;
+
+    *handler = callback;
+    if (!callback && isEmpty(*slot))
+        release(*slot);
+
+    return true;
+}
+
+bool TimRouter::isEmpty(const Slot& slot) {
+    for (size_t i = 0; i < 4; ++i) if (slot.capture[i] || slot.pulse[i] || slot.pulseHalf[i])
+        return false;
+    return !slot.update && !slot.trigger;
+}
+
+void TimRouter::release(Slot& slot) {
+    #ifndef PERIPH_USE_REGISTRY
+    auto i = uint8_t(&slot - slots + 1);
+    if (table[hash(slot.instance)] == i)
+        table[hash(slot.instance)] = 0;
+    #endif
+    slot.instance = nullptr;
+}
+
+extern "C" void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
+    PERIPH_TRACE(trace::sourceInputCapture);
+    TimRouter::dispatch(htim, TimRouter::eventCapture);
+}
+
+extern "C" void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim) {
+    PERIPH_TRACE(trace::sourcePwm);
+    TimRouter::dispatch(htim, TimRouter::eventPulse);
+}
+
+extern "C" void HAL_TIM_PWM_PulseFinishedHalfCpltCallback(TIM_HandleTypeDef *htim) {
+    PERIPH_TRACE(trace::sourcePwm);
+    TimRouter::dispatch(htim, TimRouter::eventPulseHalf);
+}
+
+extern "C" void HAL_TIM_TriggerCallback(TIM_HandleTypeDef *htim) {
+    PERIPH_TRACE(trace::sourceTim);
+    TimRouter::dispatch(htim, TimRouter::eventTrigger);
+}
+
+#endif // HAL_TIM_MODULE_ENABLED
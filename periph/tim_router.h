@@ -0,0 +1,119 @@
+#ifndef PERIPH_TIM_ROUTER_H
+#define PERIPH_TIM_ROUTER_H
+
+#include "main.h"
+#ifdef HAL_TIM_MODULE_ENABLED
+
+#include "periph/config.h"
+#include "periph/registry.h"
+#include "periph/trace.h"
+#include "Core/Inc/tim.h"
+#include "etl/function.h"
+
+namespace Project::periph { struct TimRouter; }
+
+/// TIM interrupt router.
+/// owns one slot per timer holding the handlers of each event and channel,
+/// a HAL TIM callback is dispatched with one table lookup instead of scanning every driver
+/// @note the period elapsed callback is usually defined by cubeMX in main.c for the HAL time base,
+///     call TimRouter::dispatch(htim, TimRouter::eventUpdate) from it to route update events
+struct Project::periph::TimRouter {
+    using Callback = etl::Function<void(), void*>;
+
+    enum { eventCapture, eventPulse, eventPulseHalf, eventUpdate, eventTrigger };
+
+    struct Slot {
+        TIM_TypeDef* instance = nullptr;
+        Callback capture[4] = {};
+        Callback pulse[4] = {};
+        Callback pulseHalf[4] = {};
+        Callback update = {};
+        Callback trigger = {};
+    };
+
+    #ifdef PERIPH_USE_REGISTRY
+    static constexpr size_t maxTimers = registry::Tim::count > 0 ? registry::Tim::count : 1; ///< one slot per timer of the registry, at its position
+    #else
+    static constexpr size_t maxTimers = PERIPH_TIM_ROUTER_MAX_TIMERS;
+    #endif
+
+    static Slot slots[maxTimers];
+    static uint8_t table[64]; ///< slot index + 1, indexed by hash()
+
+    /// register a handler, or unregister it with an empty callback.
+    /// a handler is not replaced, detach the previous one first: two drivers on the same event and channel,
+    /// e.g. an InputCapture and an Encoder on TIM_CHANNEL_1 of one timer, are rejected instead of overwriting each other
+    /// @param htim tim handler
+    /// @param event eventCapture, eventPulse, eventPulseHalf, eventUpdate, or eventTrigger
+    /// @param channel TIM_CHANNEL_1..4, ignored for eventUpdate and eventTrigger. channel 5 and 6 are refused
+    /// @param callback handler
+    /// @retval false if all slots are taken, the channel is not 1..4, or the event of this channel already has a handler
+    static bool attach(TIM_HandleTypeDef& htim, int event, uint32_t channel, Callback callback);
+
+    /// unregister a handler, the slot of the timer is freed with its last handler
+    static void detach(TIM_HandleTypeDef& htim, int event, uint32_t channel) { attach(htim, event, channel, {}); }
+
+    /// invoke the handler of an event, htim->Channel selects the channel.
+    /// capture and pulse events with HAL_TIM_ACTIVE_CHANNEL_CLEARED, or of channel 5 and 6, are dropped
+    static void dispatch(TIM_HandleTypeDef* htim, int event) {
+        auto slot = find(htim->Instance);
+        if (slot == nullptr)
+            return;
+
+        uint32_t index = 0;
+        if (event == eventCapture || event == eventPulse || event == eventPulseHalf) {
+            if (htim->Channel == HAL_TIM_ACTIVE_CHANNEL_CLEARED)
+                return;
+            index = channelIndex(htim->Channel);
+            if (index > 3)
+                return;
+        }
+
+        PERIPH_TRACE(event == eventCapture ? trace::sourceInputCaptureUser :
+            event == eventPulse || event == eventPulseHalf ? trace::sourcePwmUser : trace::sourceTimUser);
+        switch (event) {
+            case eventCapture: slot->capture[index](); break;
+            case eventPulse: slot->pulse[index](); break;
+            case eventPulseHalf: slot->pulseHalf[index](); break;
+            case eventUpdate: slot->update(); break;
+            case eventTrigger: slot->trigger(); break;
+            default: break;
+        }
+    }
+
+    /// find the slot of a timer
+    static Slot* find(TIM_TypeDef* instance) {
+        #ifdef PERIPH_USE_REGISTRY
+        int i = registry::Tim::index(reinterpret_cast<uintptr_t>(instance));
+        return i < 0 || slots[i].instance != instance ? nullptr : &slots[i];
+        #else
+        uint8_t index = table[hash(instance)];
+        if (index > 0 && slots[index - 1].instance == instance)
+            return &slots[index - 1];
+
+        // hash collision
+        for (auto& slot : slots) if (slot.instance == instance)
+            return &slot;
+
+        return nullptr;
+        #endif
+    }
+
+    /// TIMx base addresses are 0x400 apart on APB1 and APB2, APB2 starts at +0x10000
+    static uint32_t hash(TIM_TypeDef* instance) {
+        auto addr = reinterpret_cast<uintptr_t>(instance);
+        return ((addr >> 10) & 0x1F) | ((addr >> 11) & 0x20);
+    }
+
+    /// HAL_TIM_ACTIVE_CHANNEL_x to channel index 0..5, activeChannel must not be HAL_TIM_ACTIVE_CHANNEL_CLEARED
+    static uint32_t channelIndex(uint32_t activeChannel) {
+        return uint32_t(__builtin_ctz(activeChannel));
+    }
+
+private:
+    static bool isEmpty(const Slot& slot);
+    static void release(Slot& slot);
+};
+
+#endif // HAL_TIM_MODULE_ENABLED
+#endif // PERIPH_TIM_ROUTER_H
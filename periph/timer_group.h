@@ -0,0 +1,81 @@
+#ifndef PERIPH_TIMER_GROUP_H
+#define PERIPH_TIMER_GROUP_H
+
+#include "main.h"
+#ifdef HAL_TIM_MODULE_ENABLED
+
+#include "periph/config.h"
+#include "Core/Inc/tim.h"
+
+namespace Project::periph { template <size_t N> struct TimerGroup; }
+
+/// timers started by one trigger event with programmed phase offsets.
+/// the master timer drives its slaves through TRGO = enable, each slave runs in trigger mode from its ITRx,
+/// a slave can forward the trigger to the next timer of a chain
+/// @note requirements: internal trigger connection between master and slaves, see reference manual TIMx internal trigger connection
+/// @example
+///     TimerGroup<2> group { .master = htim1, .slaves = {{&htim3, TIM_TS_ITR0}, {&htim4, TIM_TS_ITR0, period / 2}} };
+///     group.init();
+///     pwm1.start(); pwm3.start(); pwm4.start(); // slave counters are held until the trigger
+///     group.start();
+template <size_t N>
+struct Project::periph::TimerGroup {
+    struct Slave {
+        TIM_HandleTypeDef* htim;    ///< tim handler generated by cubeMX
+        uint32_t inputTrigger;      ///< TIM_TS_ITRx connected to the TRGO of its master
+        uint32_t phase = 0;         ///< counter value loaded before the trigger
+        bool forward = false;       ///< forward the trigger to the slaves of this timer
+    };
+
+    TIM_HandleTypeDef& master;      ///< tim handler generated by cubeMX
+    Slave slaves[N];                ///< slaves, ordered from the master down the chain
+
+    TimerGroup(const TimerGroup&) = delete;             ///< disable copy constructor
+    TimerGroup& operator=(const TimerGroup&) = delete;  ///< disable copy assignment
+
+    /// configure trigger output of the master and trigger mode of the slaves
+    void init() {
+        TIM_MasterConfigTypeDef masterConfig = {};
+        masterConfig.MasterOutputTrigger = TIM_TRGO_ENABLE;
+        masterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_ENABLE;
+        HAL_TIMEx_MasterConfigSynchronization(&master, &masterConfig);
+
+        for (auto& slave : slaves) {
+            TIM_SlaveConfigTypeDef slaveConfig = {};
+            slaveConfig.SlaveMode = TIM_SLAVEMODE_TRIGGER;
+            slaveConfig.InputTrigger = slave.inputTrigger;
+            slaveConfig.TriggerPolarity = TIM_TRIGGERPOLARITY_RISING;
+            slaveConfig.TriggerPrescaler = TIM_TRIGGERPRESCALER_DIV1;
+            HAL_TIM_SlaveConfigSynchro(slave.htim, &slaveConfig);
+
+            if (slave.forward)
+                HAL_TIMEx_MasterConfigSynchronization(slave.htim, &masterConfig);
+        }
+    }
+
+    /// restore free running slaves
+    void deinit() {
+        stop();
+        for (auto& slave : slaves)
+            slave.htim->Instance->SMCR &= ~TIM_SMCR_SMS;
+    }
+
+    /// stop all counters, load the phase offsets, and start all counters with one trigger event
+    void start() {
+        stop();
+        for (auto& slave : slaves)
+            __HAL_TIM_SET_COUNTER(slave.htim, slave.phase);
+        __HAL_TIM_SET_COUNTER(&master, 0);
+        __HAL_TIM_ENABLE(&master);
+    }
+
+    /// stop all counters, master first. __HAL_TIM_DISABLE is not used since it keeps counters with active channels running
+    void stop() {
+        master.Instance->CR1 &= ~TIM_CR1_CEN;
+        for (auto& slave : slaves)
+            slave.htim->Instance->CR1 &= ~TIM_CR1_CEN;
+    }
+};
+
+#endif // HAL_TIM_MODULE_ENABLED
+#endif // PERIPH_TIMER_GROUP_H
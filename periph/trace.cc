@@ -0,0 +1,96 @@
+#include "periph/trace.h"
+
+#ifdef PERIPH_USE_TRACE
+
+using namespace Project::periph;
+
+trace::Stats trace::stats[trace::sourceCount];
+
+namespace {
+    constexpr uint8_t version = 2;
+    constexpr size_t headerSize = 12;
+    constexpr size_t recordSize = 28 + 4 * trace::histogramSize;
+
+    uint8_t* put(uint8_t* out, uint32_t value) {
+        for (int i = 0; i < 4; ++i, value >>= 8)
+            *out++ = uint8_t(value);
+        return out;
+    }
+}
+
+void trace::init() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    reset();
+}
+
+void trace::reset() {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (auto& s : stats)
+        s = {};
+    __set_PRIMASK(primask);
+}
+
+void trace::record(Source source, uint32_t cycles) {
+    size_t bucket = cycles == 0 ? 0 : 32 - __builtin_clz(cycles);
+    if (bucket >= histogramSize)
+        bucket = histogramSize - 1;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    auto& s = stats[source];
+    if (s.count == 0 || cycles < s.min)
+        s.min = cycles;
+    if (cycles > s.max)
+        s.max = cycles;
+    s.count++;
+    s.total += cycles;
+    s.histogram[bucket]++;
+    __set_PRIMASK(primask);
+}
+
+trace::Stats trace::snapshot(Source source) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Stats res = stats[source];
+    __set_PRIMASK(primask);
+    return res;
+}
+
+size_t trace::dump(Writer write) {
+    size_t recorded = 0;
+    for (auto& s : stats) if (s.count > 0)
+        recorded++;
+
+    // magic, version, number of records, record size, core clock
+    uint8_t header[headerSize] = {'P', 'T', 'R', 'C', version, uint8_t(recorded), uint8_t(recordSize), uint8_t(recordSize >> 8)};
+    put(header + 8, SystemCoreClock);
+    write(header, sizeof(header));
+    size_t n = sizeof(header);
+
+    for (size_t i = 0, written = 0; i < sourceCount && written < recorded; ++i) {
+        Stats s = snapshot(Source(i));
+        if (s.count == 0)
+            continue;
+
+        // source, 3 reserved bytes, count, min, max, total low, total high, histogram
+        uint8_t record[recordSize] = {uint8_t(i)};
+        uint8_t* out = put(record + 4, s.count);
+        out = put(out, s.min);
+        out = put(out, s.max);
+        out = put(out, uint32_t(s.total));
+        out = put(out, uint32_t(s.total >> 32));
+        for (auto bucket : s.histogram)
+            out = put(out, bucket);
+
+        write(record, sizeof(record));
+        n += sizeof(record);
+        written++;
+    }
+
+    return n;
+}
+
+#endif // PERIPH_USE_TRACE
@@ -0,0 +1,102 @@
+#ifndef PERIPH_TRACE_H
+#define PERIPH_TRACE_H
+
+#include "main.h"
+#include "periph/config.h"
+
+#define PERIPH_TRACE_CONCAT_(a, b) a##b
+#define PERIPH_TRACE_CONCAT(a, b) PERIPH_TRACE_CONCAT_(a, b)
+
+#ifdef PERIPH_USE_TRACE
+
+#include "etl/function.h"
+
+/// measure the cycles from here to the end of the enclosing scope
+/// @param source trace::Source
+#define PERIPH_TRACE(source) Project::periph::trace::Scope PERIPH_TRACE_CONCAT(periphTraceScope, __LINE__) { source }
+
+/// execution time of interrupt handlers and user callbacks measured with the DWT cycle counter.
+/// each source keeps count, min, max, total and a log2 histogram of its cycles.
+/// dump() exports them in a little endian binary format, decode it with tools/trace_decode.py
+/// @note requirements: Cortex-M3 or above. PERIPH_USE_TRACE, otherwise PERIPH_TRACE() expands to nothing
+/// @example
+///     trace::init();
+///     ...
+///     trace::dump({+[] (void* uart, const void* buf, size_t len) {
+///         static_cast<UART*>(uart)->transmitBlocking(static_cast<const uint8_t*>(buf), len);
+///     }, &uart2});
+namespace Project::periph::trace {
+    /// a HAL callback and the user callbacks it runs are separate sources
+    enum Source : uint8_t {
+        sourceUart, sourceUartUser,
+        sourceCan, sourceCanUser,
+        sourceAdc, sourceAdcUser,
+        sourceI2s, sourceI2sUser,
+        sourcePwm, sourcePwmUser,
+        sourceInputCapture, sourceInputCaptureUser,
+        sourceTim, sourceTimUser,
+        sourceExti, sourceExtiUser,
+        sourceUsb, sourceUsbUser,
+        sourceWorkQueue,    ///< dispatch latency, from WorkQueue::post() to the start of the work
+        sourceApp, ///< first of PERIPH_TRACE_APP_SOURCES sources free for the application
+        sourceCount = sourceApp + PERIPH_TRACE_APP_SOURCES,
+    };
+
+    static constexpr size_t histogramSize = 32; ///< bucket i counts durations of 2^(i-1) to 2^i - 1 cycles
+
+    struct Stats {
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t total;
+        uint32_t histogram[histogramSize];
+
+        /// mean cycles
+        [[nodiscard]]
+        uint32_t mean() const { return count == 0 ? 0 : uint32_t(total / count); }
+    };
+
+    using Writer = etl::Function<void(const void*, size_t), void*>;
+
+    /// statistics of each source
+    extern Stats stats[sourceCount];
+
+    /// enable the cycle counter and clear the statistics
+    void init();
+
+    /// clear the statistics
+    void reset();
+
+    /// add a duration to a source, may be called from interrupt context
+    void record(Source source, uint32_t cycles);
+
+    /// consistent copy of the statistics of a source
+    Stats snapshot(Source source);
+
+    /// write a snapshot of every source that has been recorded
+    /// @param write any stream, e.g. uart or usb transmit
+    /// @retval number of bytes written
+    size_t dump(Writer write);
+
+    [[nodiscard]]
+    inline uint32_t cycles() { return DWT->CYCCNT; }
+
+    /// RAII timer
+    struct Scope {
+        Source source;
+        uint32_t start;
+
+        explicit Scope(Source src) : source(src), start(cycles()) {}
+        ~Scope() { record(source, cycles() - start); }
+
+        Scope(const Scope&) = delete;               ///< disable copy constructor
+        Scope& operator=(const Scope&) = delete;    ///< disable copy assignment
+    };
+}
+
+#else
+
+#define PERIPH_TRACE(source) do {} while (0)
+
+#endif // PERIPH_USE_TRACE
+#endif // PERIPH_TRACE_H
@@ -1,4 +1,5 @@
 #include "periph/uart.h"
+#include "periph/trace.h"
 
 #ifdef HAL_UART_MODULE_ENABLED
 
@@ -6,7 +7,23 @@ using namespace Project::periph;
 
 detail::UniqueInstances<UART*, 16> UART::Instances;
 
+#ifdef PERIPH_USE_REGISTRY
+registry::Slots<UART, registry::Uart> UART::Registered;
+
+static_assert(registry::any<registry::Uart>(registry::irqGlobal, 0), "UART driver needs a UART global interrupt in the .ioc");
+#ifdef PERIPH_UART_RECEIVE_USE_DMA
+static_assert(registry::any<registry::Uart>(0, registry::dmaRx), "PERIPH_UART_RECEIVE_USE_DMA needs a UART rx DMA request in the .ioc");
+#endif
+#ifdef PERIPH_UART_TRANSMIT_USE_DMA
+static_assert(registry::any<registry::Uart>(0, registry::dmaTx), "PERIPH_UART_TRANSMIT_USE_DMA needs a UART tx DMA request in the .ioc");
+#endif
+#endif
+UART::FramePool UART::framePool;
+
 static UART* selector(UART_HandleTypeDef *huart) {
+    #ifdef PERIPH_USE_REGISTRY
+    return UART::Registered.find(huart->Instance);
+    #else
     for (auto instance : UART::Instances.instances) {
         if (instance == nullptr)
             continue;
@@ -16,24 +33,43 @@ static UART* selector(UART_HandleTypeDef *huart) {
     }
 
     return nullptr;
+    #endif
 }
 
 extern "C" void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    PERIPH_TRACE(trace::sourceUart);
     auto uart = selector(huart);
     if (uart == nullptr)
         return;
 
-    for (auto& callback : uart->rxCallbackList.instances) {
-        callback(uart->rxBuffer.data(), Size);
+    auto frame = uart->rxFrame;
+    const uint8_t* data = frame ? frame->data : uart->rxBuffer.data();
+    {
+        PERIPH_TRACE(trace::sourceUartUser);
+        for (auto& callback : uart->rxCallbackList.instances) {
+            callback(data, Size);
+        }
+
+        // hand the frame over and receive the next one into a fresh frame
+        if (frame && uart->rxFrameCallback) {
+            frame->len = Size;
+            uart->rxFrame = nullptr;
+            uart->rxFrameCallback(frame);
+        } else if (uart->rxFrameCallback) {
+            // received into rxBuffer, the pool was exhausted when this receive started
+            uart->framesMissed = uart->framesMissed + 1;
+        }
     }
     uart->init();
 }
 
 extern "C" void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    PERIPH_TRACE(trace::sourceUart);
     auto uart = selector(huart);
     if (uart == nullptr)
         return;
 
+    PERIPH_TRACE(trace::sourceUartUser);
     for (auto& callback : uart->txCallbackList.instances) {
         callback();
     }
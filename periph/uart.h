@@ -5,6 +5,8 @@
 #ifdef HAL_UART_MODULE_ENABLED
 
 #include "periph/config.h"
+#include "periph/registry.h"
+#include "periph/pool.h"
 #include "Core/Inc/usart.h"
 #include "etl/array.h"
 #include "etl/function.h"
@@ -15,35 +17,60 @@
 namespace Project::periph { struct UART; }
 
 /// UART peripheral class.
-/// @note requirements: global interrupt, rx DMA
+/// @note requirements: global interrupt, rx DMA with PERIPH_UART_RECEIVE_USE_DMA, optional with PERIPH_UART_RECEIVE_USE_AUTO
 struct Project::periph::UART {
     using RxCallback = etl::Function<void(const uint8_t*, size_t), void*>;  ///< rx callback function class
     using TxCallback = etl::Function<void(), void*>;                        ///< tx callback function class
     using Buffer = etl::Array<uint8_t, PERIPH_UART_RX_BUFFER_SIZE>;         ///< UART rx buffer class
 
+    /// received frame of a pool
+    struct Frame {
+        uint16_t len;
+        uint8_t data[PERIPH_UART_RX_BUFFER_SIZE];
+    };
+
+    using FramePool = Pool<Frame, PERIPH_UART_FRAME_POOL_SIZE>;
+    using FrameCallback = etl::Function<void(Frame*), void*>;               ///< takes ownership of a frame
+
     template <typename T>
     using GetterSetter = etl::GetterSetter<T, etl::Function<T(), const UART*>, etl::Function<void(T), const UART*>>;
     
     static detail::UniqueInstances<UART*, 16> Instances;
+    #ifdef PERIPH_USE_REGISTRY
+    static registry::Slots<UART, registry::Uart> Registered; ///< instances indexed by the registry position of huart.Instance
+    #endif
+    static FramePool framePool;     ///< frames handed to rxFrameCallback, shared by all UART instances
 
     UART_HandleTypeDef &huart;                              ///< UART handler configured by cubeMX
     detail::UniqueInstances<RxCallback, 16> rxCallbackList = {}; ///< rx callback function
     detail::UniqueInstances<TxCallback, 16> txCallbackList = {}; ///< tx callback function
     Buffer rxBuffer = {};                                   ///< rx buffer
+    FrameCallback rxFrameCallback = {};                     ///< takes ownership of each received frame, release it with framePool.release()
+    Frame* rxFrame = nullptr;                               ///< frame being received, nullptr when receiving into rxBuffer
+    volatile uint32_t framesMissed = 0;                     ///< frames received into rxBuffer because framePool was exhausted,
+                                                            ///< they only reached rxCallbackList, not rxFrameCallback
 
     UART(const UART&) = delete;             ///< disable copy constructor
     UART& operator=(const UART&) = delete;  ///< disable copy assignment
 
-    /// start receive to idle
+    /// start receive to idle, straight into a pool frame if rxFrameCallback is set and a frame is available.
+    /// when framePool is exhausted the frame falls back to rxBuffer: rxCallbackList still sees it,
+    /// rxFrameCallback does not, and framesMissed counts it
     void init() {
-        #ifdef PERIPH_UART_RECEIVE_USE_IT
-        HAL_UARTEx_ReceiveToIdle_IT(&huart, rxBuffer.data(), rxBuffer.len());
-        #endif
-        #ifdef PERIPH_UART_RECEIVE_USE_DMA
-        HAL_UARTEx_ReceiveToIdle_DMA(&huart, rxBuffer.data(), rxBuffer.len());
-        __HAL_DMA_DISABLE_IT(huart.hdmarx, DMA_IT_HT);
-        #endif
+        if (rxFrameCallback && rxFrame == nullptr)
+            rxFrame = framePool.allocate();
+        uint8_t* target = rxFrame ? rxFrame->data : rxBuffer.data();
+
+        if (isRxDma()) {
+            HAL_UARTEx_ReceiveToIdle_DMA(&huart, target, rxBuffer.len());
+            __HAL_DMA_DISABLE_IT(huart.hdmarx, DMA_IT_HT);
+        } else {
+            HAL_UARTEx_ReceiveToIdle_IT(&huart, target, rxBuffer.len());
+        }
         Instances.push(this);
+        #ifdef PERIPH_USE_REGISTRY
+        Registered.bind(huart.Instance, this);
+        #endif
     }
 
     struct InitArgs { uint32_t baudrate; RxCallback rxCallback = {}; TxCallback txCallback = {}; };
@@ -58,13 +85,18 @@ struct Project::periph::UART {
     /// disable receive
     void deinit() { 
         if (rxCallbackList.isEmpty() && txCallbackList.isEmpty()) {
-            #ifdef PERIPH_UART_RECEIVE_USE_IT
-            HAL_UART_Abort_IT(&huart); 
-            #endif
-            #ifdef PERIPH_UART_RECEIVE_USE_DMA
-            HAL_UART_DMAStop(&huart); 
-            #endif
+            if (isRxDma())
+                HAL_UART_DMAStop(&huart);
+            else
+                HAL_UART_Abort_IT(&huart);
+            if (rxFrame) {
+                framePool.release(rxFrame);
+                rxFrame = nullptr;
+            }
             Instances.pop(this);
+            #ifdef PERIPH_USE_REGISTRY
+            Registered.unbind(huart.Instance, this);
+            #endif
         }
     }
 
@@ -95,11 +127,32 @@ struct Project::periph::UART {
     ///     - .len buffer length
     /// @retval HAL_StatusTypeDef (see stm32fXxx_hal_def.h)
     int transmit(const void *buf, size_t len) { 
-        #ifdef PERIPH_UART_TRANSMIT_USE_IT
-        return HAL_UART_Transmit_IT(&huart, (uint8_t *) buf, len); 
+        if (isTxDma())
+            return HAL_UART_Transmit_DMA(&huart, (uint8_t *) buf, len);
+        return HAL_UART_Transmit_IT(&huart, (uint8_t *) buf, len);
+    }
+
+    /// receive transfer mode of this instance, see PERIPH_UART_RECEIVE_USE_xxx
+    [[nodiscard]]
+    bool isRxDma() const {
+        #if defined(PERIPH_UART_RECEIVE_USE_DMA)
+        return true;
+        #elif defined(PERIPH_UART_RECEIVE_USE_AUTO)
+        return registry::useDma<registry::Uart>(huart.Instance, registry::dmaRx, huart.hdmarx);
+        #else
+        return false;
         #endif
-        #ifdef PERIPH_UART_TRANSMIT_USE_DMA
-        return HAL_UART_Transmit_DMA(&huart, (uint8_t *) buf, len); 
+    }
+
+    /// transmit transfer mode of this instance, see PERIPH_UART_TRANSMIT_USE_xxx
+    [[nodiscard]]
+    bool isTxDma() const {
+        #if defined(PERIPH_UART_TRANSMIT_USE_DMA)
+        return true;
+        #elif defined(PERIPH_UART_TRANSMIT_USE_AUTO)
+        return registry::useDma<registry::Uart>(huart.Instance, registry::dmaTx, huart.hdmatx);
+        #else
+        return false;
         #endif
     }
 
@@ -1,31 +1,86 @@
 #include "periph/usb.h"
+#include "periph/trace.h"
 #ifdef HAL_PCD_MODULE_ENABLED
 
 extern uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
+extern "C" USBD_HandleTypeDef hUsbDeviceFS;
 
 using namespace Project::periph;
 USBD Project::periph::usb { .rxBuffer = *(USBD::Buffer *) UserRxBufferFS };
 
+void USBD::init() {
+    #if !defined(STM32F1)
+    #ifdef PERIPH_USE_BARE_METAL
+    flushTimer.start();
+    #else
+    if (flushTimer == nullptr)
+        flushTimer = osTimerNew(+[] (void* self) { static_cast<USBD*>(self)->poll(); }, osTimerPeriodic, this, nullptr);
+
+    uint32_t ticks = osKernelGetTickFreq() / 1000;
+    osTimerStart(flushTimer, ticks > 0 ? ticks : 1);
+    #endif
+    #endif
+}
+
+#ifdef PERIPH_USB_RX_USE_RING
+static void rxArm() {
+    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+    USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+}
+
+void USBD::rxReceive(const uint8_t* pbuf, uint32_t len) {
+    rxRing.push(pbuf, len); // fits, the endpoint is only armed with room for a packet
+
+    if (rxRing.free() >= CDC_DATA_FS_MAX_PACKET_SIZE) {
+        rxArm();
+    } else {
+        rxPaused = true;
+        rxPauses++;
+    }
+}
+
+void USBD::release(size_t n) {
+    rxRing.release(n);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (rxPaused && rxRing.free() >= CDC_DATA_FS_MAX_PACKET_SIZE) {
+        rxPaused = false;
+        rxArm();
+    }
+    __set_PRIMASK(primask);
+}
+#endif
+
 extern "C" void CDC_ReceiveCplt_Callback(const uint8_t *pbuf, uint32_t len) {
+    PERIPH_TRACE(trace::sourceUsb);
     (void) pbuf;
-    for (auto& callback : usb.rxCallbackList.instances) {
-        callback(usb.rxBuffer.data(), len);
+    {
+        PERIPH_TRACE(trace::sourceUsbUser);
+        for (auto& callback : usb.rxCallbackList.instances) {
+            callback(usb.rxBuffer.data(), len);
+        }
     }
+
+    #ifdef PERIPH_USB_RX_USE_RING
+    usb.rxReceive(usb.rxBuffer.data(), len);
+    #endif
 }
 
 extern "C" void CDC_TransmitCplt_Callback(const uint8_t *pbuf, uint32_t len) {
-    for (auto& callback : usb.txCallbackList.instances) {
-        callback(pbuf, len);
+    PERIPH_TRACE(trace::sourceUsb);
+    {
+        PERIPH_TRACE(trace::sourceUsbUser);
+        for (auto& callback : usb.txCallbackList.instances) {
+            callback(pbuf, len);
+        }
     }
 
+    #if !defined(STM32F1)
+    usb.txComplete();
+    #else
     usb.isBusy = false;
-    for (size_t i = 0; i < PERIPH_CALLBACK_LIST_MAX_SIZE; ++i) {
-        if (usb.pending_buffer[i] != nullptr) {
-            usb.transmit(usb.pending_buffer[i], usb.pending_buffer_size[i]);
-            usb.pending_buffer[i] = nullptr;
-            return;
-        }
-    }
+    #endif
 }
 
 #endif
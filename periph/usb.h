@@ -5,59 +5,155 @@
 #ifdef HAL_PCD_MODULE_ENABLED
 
 #include "config.h"
+#include "periph/ring.h"
 #include "usbd_cdc_if.h"
 #include "etl/array.h"
 #include "etl/string.h"
 #include "etl/function.h"
+#ifdef PERIPH_USE_BARE_METAL
+#include "periph/event_loop.h"
+#else
+#include "cmsis_os2.h"
+#endif
 
 namespace Project::periph { struct USBD; extern USBD usb; }
 
-/// USB peripheral class
+/// USB peripheral class.
+/// small writes are copied into a transmit ring and coalesced into multi packet transfers,
+/// writes of at least PERIPH_USB_TX_ZERO_COPY_SIZE bytes are sent in place when nothing else is pending.
+/// with flushThreshold, smaller writes wait at most flushTimeout, init() starts the timer checking it.
+/// with PERIPH_USB_RX_USE_RING, OUT packets are copied into a receive ring and the host is NAKed while it is full
+/// @note requirements with PERIPH_USB_RX_USE_RING: remove USBD_CDC_SetRxBuffer and USBD_CDC_ReceivePacket
+///     from CDC_Receive_FS in usbd_cdc_if.c, the endpoint is re-armed by this class
 struct Project::periph::USBD {
     using Callback = etl::Function<void(const uint8_t*, size_t), void*>; ///< callback function class
     using CallbackList = detail::UniqueInstances<Callback, PERIPH_CALLBACK_LIST_MAX_SIZE>;
     using Buffer = etl::Array<uint8_t, APP_RX_DATA_SIZE>;                ///< USB rx buffer classs
 
+    static_assert(PERIPH_USB_TX_RING_SIZE <= 0x8000, "tx ring size must fit a single transfer");
+
     Buffer &rxBuffer;                   ///< reference to USB rx buffer
     CallbackList rxCallbackList = {};   ///< list of rx callback functions
     CallbackList txCallbackList = {};   ///< list of tx callback functions
-    bool isBusy = false;
+    volatile bool isBusy = false;       ///< a transfer is in progress
+    size_t flushThreshold = 0;          ///< pending bytes that start a transfer, 0 to start at once. smaller writes wait for flush() or flushTimeout
+    uint32_t flushTimeout = 1;          ///< ms the bytes below flushThreshold wait at most, see poll()
+    uint32_t pendingSince = 0;          ///< HAL tick of the oldest byte waiting for a transfer
+
+    SpscRing<uint8_t, PERIPH_USB_TX_RING_SIZE> txRing = {}; ///< produced by transmit, consumed by the USB interrupt
+    uint32_t txInFlight = 0;            ///< bytes of the ring in the current transfer
+    volatile bool txZeroCopy = false;   ///< the current transfer is a caller buffer
+    #ifdef PERIPH_USE_BARE_METAL
+    EventLoop::Timer flushTimer = { .interval=etl::time::milliseconds(1), .callback={+[] (void* self) {
+        static_cast<USBD*>(self)->poll();
+    }, this}, .periodic=true };
+    #else
+    osTimerId_t flushTimer = nullptr;
+    #endif
+
+    #ifdef PERIPH_USB_RX_USE_RING
+    static_assert(PERIPH_USB_RX_RING_SIZE >= 2 * CDC_DATA_FS_MAX_PACKET_SIZE, "rx ring must hold two packets");
 
-    const void* pending_buffer[PERIPH_CALLBACK_LIST_MAX_SIZE] = {};
-    size_t pending_buffer_size[PERIPH_CALLBACK_LIST_MAX_SIZE] = {};
+    /// contiguous received bytes
+    struct Span { const uint8_t* data; size_t len; };
+
+    SpscRing<uint8_t, PERIPH_USB_RX_RING_SIZE> rxRing = {}; ///< produced by the USB interrupt, consumed by the application
+    volatile bool rxPaused = false;     ///< the OUT endpoint is not armed, the host is NAKed
+    uint32_t rxPauses = 0;              ///< counts how many times the host has been throttled
+    #endif
 
     USBD(const USBD&) = delete; ///< disable copy constructor
     USBD& operator=(const USBD&) = delete;  ///< disable move constructor
 
-    /// USB transmit non blocking
+    /// start the millisecond timer calling poll(), needed when flushThreshold is used
+    void init();
+
+    /// USB transmit non blocking.
+    /// buffers of at least PERIPH_USB_TX_ZERO_COPY_SIZE bytes may be sent in place,
+    /// they must stay valid until txZeroCopy is cleared or the tx callback reports them
     /// @param buf data buffer
     /// @param len buffer length
-    /// @retval @ref USBD_StatusTypeDef (see usbd_def.h)
+    /// @retval @ref USBD_StatusTypeDef (see usbd_def.h), USBD_BUSY if the ring has no room for len bytes
     int transmit(const void *buf, size_t len) { 
         #if !defined(STM32F1)
-        if (isBusy) {
-            for (size_t i = 0; i < PERIPH_CALLBACK_LIST_MAX_SIZE; ++i) {
-                if (pending_buffer[i] == nullptr) {
-                    pending_buffer[i] = buf;
-                    pending_buffer_size[i] = len;
-                    return USBD_BUSY;
-                }
-            }
-            return USBD_FAIL;
+        if (len == 0)
+            return USBD_OK;
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (len >= PERIPH_USB_TX_ZERO_COPY_SIZE && len <= 0xFFFF && !isBusy && txRing.isEmpty()) {
+            isBusy = txZeroCopy = true;
+            int res = CDC_Transmit_FS((uint8_t*) buf, len);
+            if (res != USBD_OK)
+                isBusy = txZeroCopy = false;
+            __set_PRIMASK(primask);
+            return res;
         }
+        __set_PRIMASK(primask);
 
-        isBusy = true;
-        #endif
+        // the consumer only frees room, a check followed by a push is safe
+        if (len > txRing.free())
+            return USBD_BUSY;
+
+        if (txRing.isEmpty())
+            pendingSince = HAL_GetTick();
+        txRing.push(static_cast<const uint8_t*>(buf), len);
+        if (txRing.size() >= flushThreshold)
+            flush();
+        else
+            poll();
+        return USBD_OK;
+        #else
         return CDC_Transmit_FS((uint8_t*) buf, len); 
+        #endif
     }
 
-    /// USB transmit non blocking
+    /// USB transmit, blocks until the data is queued, or sent when it is sent in place
     /// @param buf data buffer
     /// @param len buffer length
     /// @retval @ref USBD_StatusTypeDef (see usbd_def.h)
     int transmitBlocking(const void *buf, size_t len) { 
-        while (isBusy);
+        #if !defined(STM32F1)
+        auto src = static_cast<const uint8_t*>(buf);
+        while (len > 0) {
+            size_t n = len > PERIPH_USB_TX_RING_SIZE ? PERIPH_USB_TX_RING_SIZE : len;
+            int res;
+            while ((res = transmit(src, n)) == USBD_BUSY) 
+                flush();
+            if (res != USBD_OK)
+                return res;
+            src += n;
+            len -= n;
+        }
+
+        while (txZeroCopy);
+        return USBD_OK;
+        #else
         return transmit(buf, len); 
+        #endif
+    }
+
+    /// start a transfer of the pending bytes if the link is idle
+    void flush() {
+        #if !defined(STM32F1)
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (!isBusy && !txRing.isEmpty())
+            txStart();
+        __set_PRIMASK(primask);
+        #endif
+    }
+
+    /// start a transfer of the bytes below flushThreshold once the oldest has waited flushTimeout ms,
+    /// called every millisecond by the timer of init(), by transmit() and at the end of each transfer
+    void poll() {
+        #if !defined(STM32F1)
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (!isBusy && !txRing.isEmpty() && HAL_GetTick() - pendingSince >= flushTimeout)
+            txStart();
+        __set_PRIMASK(primask);
+        #endif
     }
 
     /// write operator for any type of string
@@ -74,6 +170,69 @@ struct Project::periph::USBD {
             return *this;
         }
     }
+
+    #ifdef PERIPH_USB_RX_USE_RING
+    /// number of received bytes waiting in the ring
+    [[nodiscard]]
+    size_t available() const { return rxRing.size(); }
+
+    /// received bytes up to the end of the ring, valid until release()
+    /// @retval span of len 0 if nothing is received. call again after release() for the bytes after the wrap
+    [[nodiscard]]
+    Span peek() {
+        auto span = rxRing.readSpan();
+        return { span.data, span.len };
+    }
+
+    /// consume bytes of peek(), re-arm the OUT endpoint once there is room for a packet
+    void release(size_t n);
+
+    /// copy and consume received bytes
+    /// @param buf[out] destination
+    /// @param len maximum number of bytes
+    /// @retval number of bytes copied
+    size_t read(void* buf, size_t len) {
+        auto dest = static_cast<uint8_t*>(buf);
+        size_t total = 0;
+        for (auto span = peek(); span.len > 0 && total < len; span = peek()) {
+            size_t n = span.len < len - total ? span.len : len - total;
+            ::memcpy(dest + total, span.data, n);
+            release(n);
+            total += n;
+        }
+        return total;
+    }
+
+    /// copy an OUT packet into the ring and re-arm the endpoint if there is room, called from CDC_ReceiveCplt_Callback
+    void rxReceive(const uint8_t* pbuf, uint32_t len);
+    #endif
+
+    /// release the completed transfer and start the next one, called from CDC_TransmitCplt_Callback
+    void txComplete() {
+        if (txZeroCopy)
+            txZeroCopy = false;
+        else
+            txRing.release(txInFlight);
+
+        txInFlight = 0;
+        isBusy = false;
+
+        size_t pending = txRing.size();
+        if (pending > 0 && (pending >= flushThreshold || HAL_GetTick() - pendingSince >= flushTimeout))
+            txStart();
+    }
+
+private:
+    /// send the contiguous pending bytes, interrupts must be masked or in the USB interrupt
+    void txStart() {
+        auto span = txRing.readSpan();
+        isBusy = true;
+        txInFlight = span.len;
+        if (CDC_Transmit_FS(span.data, uint16_t(span.len)) != USBD_OK) {
+            txInFlight = 0;
+            isBusy = false;
+        }
+    }
 };
 
 #endif // HAL_PCD_MODULE_ENABLED
@@ -0,0 +1,27 @@
+#include "periph/work_queue.h"
+#include "periph/event_loop.h"
+
+using namespace Project::periph;
+
+void WorkQueue::init() {
+    #ifdef PERIPH_USE_BARE_METAL
+    EventLoop::attach(this);
+    #else
+    if (thread != nullptr)
+        return;
+
+    semaphore = osSemaphoreNew(PERIPH_WORK_QUEUE_SIZE, 0, nullptr);
+
+    osThreadAttr_t attr = {};
+    attr.name = name;
+    attr.priority = priority;
+    attr.stack_size = stackSize;
+    thread = osThreadNew(+[] (void* self) {
+        auto queue = static_cast<WorkQueue*>(self);
+        for (;;) {
+            osSemaphoreAcquire(queue->semaphore, osWaitForever);
+            queue->process();
+        }
+    }, this, &attr);
+    #endif
+}
@@ -0,0 +1,191 @@
+#ifndef PERIPH_WORK_QUEUE_H
+#define PERIPH_WORK_QUEUE_H
+
+#include "main.h"
+#include "periph/config.h"
+#include "periph/ring.h"
+#include "periph/trace.h"
+#ifndef PERIPH_USE_BARE_METAL
+#include "cmsis_os2.h"
+#endif
+#include "etl/function.h"
+#include <cstring>
+#include <type_traits>
+
+namespace Project::periph {
+    struct WorkQueue;
+    template <typename Callback> struct Deferred;
+}
+
+/// deferred interrupt work.
+/// interrupts post a function with a copy of its payload into a lock-free ring, a worker thread at a configurable priority runs them in order.
+/// use one queue per priority level.
+/// with PERIPH_USE_BARE_METAL there is no worker thread, EventLoop::run() processes the queues in descending priority,
+/// priority is then a uint8_t instead of osPriority_t and stackSize does not exist
+/// @note requirements: CMSIS-RTOS2, or PERIPH_USE_BARE_METAL
+struct Project::periph::WorkQueue {
+    using Function = void(*)(void* context, const uint8_t* payload, size_t len);
+
+    struct Item {
+        Function fn;
+        void* context;
+        uint16_t len;
+        #ifdef PERIPH_USE_TRACE
+        uint32_t posted;    ///< cycle counter at post()
+        #endif
+        uint8_t payload[PERIPH_WORK_QUEUE_PAYLOAD_SIZE];
+    };
+
+    const char* name = "work";
+    #ifdef PERIPH_USE_BARE_METAL
+    uint8_t priority = 0;                           ///< event loop order, higher first
+    #else
+    osPriority_t priority = osPriorityAboveNormal; ///< worker thread priority
+    uint32_t stackSize = 1024;                      ///< worker thread stack size in bytes
+    #endif
+
+    MpscRing<Item, PERIPH_WORK_QUEUE_SIZE> items = {};
+    volatile uint32_t dropped = 0;          ///< counts posts lost because the queue was full
+    volatile uint32_t highWater = 0;        ///< maximum number of waiting items
+    #ifndef PERIPH_USE_BARE_METAL
+    osSemaphoreId_t semaphore = nullptr;
+    osThreadId_t thread = nullptr;
+    #endif
+
+    WorkQueue(const WorkQueue&) = delete;               ///< disable copy constructor
+    WorkQueue& operator=(const WorkQueue&) = delete;    ///< disable copy assignment
+
+    /// create the worker thread, or with PERIPH_USE_BARE_METAL add this queue to the event loop
+    void init();
+
+    /// post work, may be called from interrupt context
+    /// @param fn function run by the worker
+    /// @param context first argument of fn
+    /// @param payload bytes copied into the queue, up to PERIPH_WORK_QUEUE_PAYLOAD_SIZE
+    /// @param len payload length
+    /// @retval false if the queue is full
+    bool post(Function fn, void* context, const void* payload = nullptr, size_t len = 0) {
+        if (len > PERIPH_WORK_QUEUE_PAYLOAD_SIZE)
+            len = PERIPH_WORK_QUEUE_PAYLOAD_SIZE;
+
+        bool posted = items.emplace([=] (Item& item) {
+            item.fn = fn;
+            item.context = context;
+            item.len = uint16_t(len);
+            #ifdef PERIPH_USE_TRACE
+            item.posted = trace::cycles();
+            #endif
+            if (len > 0)
+                ::memcpy(item.payload, payload, len);
+        });
+
+        if (!posted) {
+            dropped = dropped + 1;
+            return false;
+        }
+
+        uint32_t used = items.size();
+        if (used > highWater)
+            highWater = used;
+
+        #ifndef PERIPH_USE_BARE_METAL
+        osSemaphoreRelease(semaphore);
+        #endif
+        return true;
+    }
+
+    /// run the posted work, called by the worker thread or the event loop.
+    /// with PERIPH_USE_TRACE, trace::sourceWorkQueue records the cycles from post() to the start of each item
+    /// @retval number of items run
+    size_t process() {
+        size_t n = 0;
+        for (Item* item; (item = items.front()) != nullptr; items.pop(), ++n) {
+            #ifdef PERIPH_USE_TRACE
+            trace::record(trace::sourceWorkQueue, trace::cycles() - item->posted);
+            #endif
+            item->fn(item->context, item->payload, item->len);
+        }
+        return n;
+    }
+};
+
+namespace Project::periph::detail {
+    /// copies the arguments of a deferred callback into a payload and back
+    template <typename... Args> struct DeferredArgs;
+
+    template <>
+    struct DeferredArgs<> {
+        static size_t pack(uint8_t*) { return 0; }
+
+        template <typename F>
+        static void unpack(F& fn, const uint8_t*, size_t) { fn(); }
+    };
+
+    /// byte buffers, truncated to PERIPH_WORK_QUEUE_PAYLOAD_SIZE
+    template <>
+    struct DeferredArgs<const uint8_t*, size_t> {
+        static size_t pack(uint8_t* out, const uint8_t* buf, size_t len) {
+            if (len > PERIPH_WORK_QUEUE_PAYLOAD_SIZE) len = PERIPH_WORK_QUEUE_PAYLOAD_SIZE;
+            ::memcpy(out, buf, len);
+            return len;
+        }
+
+        template <typename F>
+        static void unpack(F& fn, const uint8_t* payload, size_t len) { fn(payload, len); }
+    };
+
+    /// single value of a trivially copyable type, e.g. CAN::Message&
+    template <typename T>
+    struct DeferredArgs<T> {
+        using Value = std::remove_cv_t<std::remove_reference_t<T>>;
+        static_assert(std::is_trivially_copyable_v<Value>, "deferred argument must be trivially copyable");
+        static_assert(sizeof(Value) <= PERIPH_WORK_QUEUE_PAYLOAD_SIZE, "deferred argument does not fit the payload");
+
+        static size_t pack(uint8_t* out, const Value& value) {
+            ::memcpy(out, &value, sizeof(Value));
+            return sizeof(Value);
+        }
+
+        template <typename F>
+        static void unpack(F& fn, const uint8_t* payload, size_t) {
+            Value value;
+            ::memcpy(&value, payload, sizeof(Value));
+            fn(value);
+        }
+    };
+}
+
+/// run a driver callback in a work queue instead of in the interrupt.
+/// callback() has the signature of the driver callback and posts a copy of its arguments,
+/// handler is invoked with them by the worker thread
+/// @example
+///     Deferred<UART::RxCallback> onReceive = { .queue = workQueue, .handler = {parse, nullptr} };
+///     uart.init({.baudrate=115200, .rxCallback=onReceive.callback()});
+template <typename... Args>
+struct Project::periph::Deferred<Project::etl::Function<void(Args...), void*>> {
+    using Callback = etl::Function<void(Args...), void*>;
+    using Packer = detail::DeferredArgs<Args...>;
+
+    WorkQueue& queue;       ///< queue running the handler
+    Callback handler;       ///< invoked by the worker thread
+
+    Deferred(const Deferred&) = delete;             ///< disable copy constructor
+    Deferred& operator=(const Deferred&) = delete;  ///< disable copy assignment
+
+    /// callback to register to the driver
+    [[nodiscard]]
+    Callback callback() {
+        return {+[] (void* self, Args... args) { static_cast<Deferred*>(self)->post(args...); }, this};
+    }
+
+    /// post the arguments to the queue
+    bool post(Args... args) {
+        uint8_t payload[PERIPH_WORK_QUEUE_PAYLOAD_SIZE];
+        size_t len = Packer::pack(payload, args...);
+        return queue.post(+[] (void* self, const uint8_t* data, size_t n) {
+            Packer::unpack(static_cast<Deferred*>(self)->handler, data, n);
+        }, this, payload, len);
+    }
+};
+
+#endif // PERIPH_WORK_QUEUE_H
@@ -0,0 +1,16 @@
+#ifndef PERIPH_TESTS_CHECK_H
+#define PERIPH_TESTS_CHECK_H
+
+// checks shared by the host tests: CHECK() prints and counts a failure and goes on,
+// main() returns checkResult() so ctest sees any failure
+
+#include <cstdio>
+
+inline int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { std::printf("FAIL %s:%d: ", __FILE__, __LINE__); std::printf(__VA_ARGS__); std::printf("\n"); failures++; } } while (0)
+
+/// exit code of a test
+inline int checkResult() { return failures == 0 ? 0 : 1; }
+
+#endif // PERIPH_TESTS_CHECK_H
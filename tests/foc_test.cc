@@ -0,0 +1,88 @@
+// accuracy of the fixed point kernel of periph/foc.h and its cost per call on the host
+#include "periph/foc.h"
+#include "check.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace Project::periph;
+
+/// keep a value alive without a memory access
+template <typename T>
+static inline void keep(const T& value) { asm volatile("" : : "g"(&value) : "memory"); }
+
+static uint64_t ticks() {
+    #if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+    #else
+    return 0;
+    #endif
+}
+
+/// ns and time stamp counter ticks per call of fn(i)
+template <typename F>
+static void bench(const char* name, F&& fn) {
+    constexpr uint32_t n = 20'000'000;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t t0 = ticks();
+    for (uint32_t i = 0; i < n; ++i)
+        fn(i);
+    uint64_t t1 = ticks();
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-24s %7.2f ns/call %7.1f tsc/call\n", name, s / n * 1e9, double(t1 - t0) / n);
+}
+
+static void accuracy() {
+    int worst = 0;
+    for (uint32_t angle = 0; angle < 65536; ++angle) {
+        double exact = std::sin(angle * 2 * M_PI / 65536) * 32767;
+        int error = int(std::lround(std::fabs(foc::sin(uint16_t(angle)) - exact)));
+        if (error > worst) worst = error;
+    }
+    CHECK(worst <= 15, "sin max error %d LSB", worst);
+    std::printf("%-24s %7d LSB\n", "sin max error", worst);
+
+    // a rotating vector in the linear range stays inside the period and round trips through park,
+    // sin^2 + cos^2 is off by up to 2 * worst LSB, which scales q
+    constexpr uint32_t period = 4200;
+    constexpr int32_t q = 18000;
+    const int32_t tolerance = q * (2 * worst + 2) / 32767 + 2;
+    int32_t roundTrip = 0;
+    for (uint32_t angle = 0; angle < 65536; angle += 7) {
+        auto sc = foc::sinCos(uint16_t(angle));
+        auto ab = foc::inversePark({0, q}, sc);
+        auto duty = foc::svpwm(ab, period);
+        CHECK(duty.a >= 0 && duty.a <= int32_t(period) && duty.b >= 0 && duty.b <= int32_t(period) && duty.c >= 0 && duty.c <= int32_t(period),
+            "svpwm out of range at angle %u", angle);
+        auto dq = foc::park(ab, sc);
+        int32_t error = std::max(std::abs(dq.d), std::abs(dq.q - q));
+        CHECK(error <= tolerance, "park round trip %d %d at angle %u", dq.d, dq.q, angle);
+        roundTrip = std::max(roundTrip, error);
+    }
+    std::printf("%-24s %7d LSB\n", "park round trip error", roundTrip);
+}
+
+int main() {
+    accuracy();
+
+    bench("sinCos", [] (uint32_t i) { keep(foc::sinCos(uint16_t(i * 40503))); });
+    bench("clarke + park", [] (uint32_t i) {
+        auto sc = foc::sinCos(uint16_t(i * 40503));
+        keep(foc::park(foc::clarke(int32_t(i & 0x3FFF), -int32_t(i & 0x1FFF)), sc));
+    });
+    bench("inversePark + svpwm", [] (uint32_t i) {
+        auto sc = foc::sinCos(uint16_t(i * 40503));
+        keep(foc::svpwm(foc::inversePark({int32_t(i & 0x3FF), 18000}, sc), 4200));
+    });
+    bench("current loop transforms", [] (uint32_t i) {
+        auto sc = foc::sinCos(uint16_t(i * 40503));
+        auto dq = foc::park(foc::clarke(int32_t(i & 0x3FFF), -int32_t(i & 0x1FFF)), sc);
+        keep(foc::svpwm(foc::inversePark({dq.d >> 2, 18000 - (dq.q >> 2)}, sc), 4200));
+    });
+
+    return checkResult();
+}
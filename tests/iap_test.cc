@@ -0,0 +1,156 @@
+// IAP streaming into a simulated STM32F4 flash, checks the programmed slot and reports MB/s.
+// the backend only copies, the numbers are the cost of the engine: feed() copies, block handoff, erase ahead
+#include "periph/iap.h"
+#include "check.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Project::periph;
+
+template <typename F>
+static double seconds(F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// 1M of flash with the F4 sectors, 4 x 16K, 64K, 7 x 128K. erased bits are 1, programming only clears bits
+namespace flash {
+    constexpr uint32_t base = 0x08000000;
+    constexpr uint32_t size = 0x100000;
+    static std::vector<uint8_t> memory(size, 0x00);
+    static uint32_t erases = 0;
+    static uint32_t programErrors = 0;
+
+    static uint32_t sectorEnd(uint32_t offset) {
+        if (offset < 0x10000) return (offset & ~0x3FFFu) + 0x4000;
+        if (offset < 0x20000) return 0x20000;
+        return (offset & ~0x1FFFFu) + 0x20000;
+    }
+
+    static uint32_t erase(uint32_t address) {
+        if (address < base || address >= base + size)
+            return 0;
+        uint32_t offset = address - base;
+        uint32_t end = sectorEnd(offset);
+        uint32_t start = offset < 0x10000 ? offset & ~0x3FFFu : offset < 0x20000 ? 0x10000 : offset & ~0x1FFFFu;
+        std::fill(memory.begin() + start, memory.begin() + end, 0xFF);
+        erases++;
+        return base + end;
+    }
+
+    static bool program(uint32_t address, const uint8_t* data, size_t len) {
+        if (address < base || address + len > base + size || len % 8 != 0 || address % 4 != 0)
+            return programErrors++, false;
+        uint8_t* dest = memory.data() + (address - base);
+        for (size_t i = 0; i < len; ++i) {
+            if (dest[i] != 0xFF)
+                return programErrors++, false;
+            dest[i] &= data[i];
+        }
+        return true;
+    }
+}
+
+static const IAP::Slot slotA = {0x08020000, 0x60000};
+static const IAP::Slot slotB = {0x08080000, 0x60000};
+
+static std::vector<uint8_t> image(size_t len) {
+    std::vector<uint8_t> res(len);
+    uint32_t x = 0x12345678;
+    for (auto& b : res) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        b = uint8_t(x);
+    }
+    return res;
+}
+
+static void verify(const char* name, IAP& iap, const std::vector<uint8_t>& img) {
+    CHECK(iap.state == IAP::stateProgrammed, "%s: state %d", name, int(iap.state));
+    CHECK(flash::programErrors == 0, "%s: %u program errors", name, flash::programErrors);
+    const uint8_t* slot = flash::memory.data() + (slotB.address - flash::base);
+    CHECK(std::equal(img.begin(), img.end(), slot), "%s: slot content differs from the image", name);
+}
+
+static void report(const char* name, size_t bytes, double s, const IAP& iap) {
+    std::printf("%-28s %10zu bytes %8.3f s %8.1f MB/s  %u erases  %u overruns\n",
+        name, bytes, s, bytes / s / 1e6, flash::erases, iap.overruns);
+}
+
+/// feed and process from one thread, the engine cost alone
+static void sequential() {
+    auto img = image(0x5F123);
+    IAP iap = { .slots={slotA, slotB}, .backend={flash::erase, flash::program} };
+    constexpr int rounds = 200;
+    constexpr size_t chunk = 64;
+    size_t total = 0;
+    flash::erases = 0;
+
+    double s = seconds([&] {
+        for (int r = 0; r < rounds; ++r) {
+            CHECK(iap.begin(uint32_t(img.size())), "sequential: begin failed");
+            for (size_t pos = 0; pos < img.size();) {
+                size_t n = img.size() - pos < chunk ? img.size() - pos : chunk;
+                size_t accepted = iap.feed(img.data() + pos, n);
+                pos += accepted;
+                if (accepted < n || pos == img.size())
+                    iap.process();
+            }
+            iap.process();
+            total += img.size();
+        }
+    });
+
+    verify("sequential", iap, img);
+    CHECK(flash::erases == rounds * 3u, "sequential: %u erases, expected 3 per round", flash::erases);
+    report("sequential feed/process", total, s, iap);
+}
+
+/// feed from a thread standing in for the rx interrupt, process from the main thread
+static void concurrent() {
+    auto img = image(0x5FFF8);
+    IAP iap = { .slots={slotA, slotB}, .backend={flash::erase, flash::program} };
+    constexpr int rounds = 50;
+    size_t total = 0;
+    flash::erases = 0;
+
+    double s = seconds([&] {
+        for (int r = 0; r < rounds; ++r) {
+            CHECK(iap.begin(uint32_t(img.size())), "concurrent: begin failed");
+            std::thread feeder([&] {
+                for (size_t pos = 0; pos < img.size();) {
+                    size_t n = img.size() - pos < 512 ? img.size() - pos : 512;
+                    size_t accepted = iap.feed(img.data() + pos, n);
+                    pos += accepted;
+                    if (accepted < n)
+                        std::this_thread::yield();
+                }
+            });
+            while (iap.process() == IAP::stateReceiving)
+                std::this_thread::yield();
+            feeder.join();
+            total += img.size();
+        }
+    });
+
+    verify("concurrent", iap, img);
+    report("concurrent feed/process", total, s, iap);
+}
+
+/// an image larger than the slot is refused, the flash is untouched
+static void tooLarge() {
+    IAP iap = { .slots={slotA, slotB}, .backend={flash::erase, flash::program} };
+    flash::erases = 0;
+    CHECK(!iap.begin(slotB.size + 1), "begin accepted an image larger than the slot");
+    CHECK(flash::erases == 0, "begin erased for a refused image");
+}
+
+int main() {
+    tooLarge();
+    sequential();
+    concurrent();
+    return checkResult();
+}
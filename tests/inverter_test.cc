@@ -0,0 +1,73 @@
+// Inverter::init on a simulated advanced timer: the registers it writes and the ADC trigger edges on TRGO = OC4REF
+#include "periph/inverter.h"
+#include "check.h"
+
+using namespace Project::periph;
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Stop(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStart(TIM_HandleTypeDef*, uint32_t, uint32_t, uint32_t*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStop(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+
+static TIM_TypeDef tim = {};
+static TIM_HandleTypeDef htim = { &tim, HAL_TIM_ACTIVE_CHANNEL_CLEARED, {}, {} };
+
+/// rising edges of OC4REF in PWM mode 1 (active while CNT < CCR4) over one center aligned period,
+/// counting up 0..ARR then down to 0, and the counter value where the last one happened
+static int triggers(uint32_t& at) {
+    int edges = 0;
+    bool last = tim.CNT < tim.CCR4;
+    auto step = [&] (uint32_t cnt) {
+        bool ref = cnt < tim.CCR4;
+        if (ref && !last) {
+            edges++;
+            at = cnt;
+        }
+        last = ref;
+    };
+
+    for (uint32_t cnt = 1; cnt <= tim.ARR; ++cnt) step(cnt);
+    for (uint32_t cnt = tim.ARR; cnt-- > 0;) step(cnt);
+    return edges;
+}
+
+static void defaults() {
+    tim.BDTR = 0x0C00 | 0x0300;     // cubeMX off states and lock bits, kept by init()
+    tim.CR2 = 0x0100;               // cubeMX OIS1, kept by init()
+
+    Inverter inverter = { .htim=htim };
+    inverter.init({ .period=4200, .deadTime=40 });
+
+    CHECK((tim.CR2 & TIM_CR2_MMS) == TIM_TRGO_OC4REF, "TRGO source %#x", tim.CR2 & TIM_CR2_MMS);
+    CHECK((tim.CR2 & ~TIM_CR2_MMS) == 0x0100, "CR2 outside MMS changed to %#x", tim.CR2);
+    CHECK(tim.BDTR == (0x0C00 | 0x0300 | 40), "BDTR %#x", tim.BDTR);
+    CHECK(tim.CCR1 == 2100 && tim.CCR2 == 2100 && tim.CCR3 == 2100, "phases not at 50%%");
+
+    uint32_t at = 0;
+    int edges = triggers(at);
+    CHECK(edges == 1, "default configuration: %d ADC trigger edges per period", edges);
+    CHECK(at >= tim.ARR - 2, "default trigger at CNT %u, not at the center of the low side on time", at);
+    inverter.deinit();
+}
+
+static void explicitTrigger() {
+    Inverter inverter = { .htim=htim };
+    uint32_t at = 0;
+
+    inverter.init({ .period=4200, .adcTrigger=1 });
+    CHECK(triggers(at) == 1 && at == 0, "adcTrigger 1 does not trigger at the underflow");
+    inverter.deinit();
+
+    // documented: CCR4 = 0 keeps OC4REF low
+    inverter.init({ .period=4200, .adcTrigger=0 });
+    CHECK(triggers(at) == 0, "adcTrigger 0 triggers");
+    inverter.deinit();
+}
+
+int main() {
+    defaults();
+    explicitTrigger();
+    return checkResult();
+}
@@ -0,0 +1,78 @@
+// dispatch latency of periph/work_queue.h, from post() to the start of the work item.
+// built twice: with PERIPH_USE_BARE_METAL EventLoop::runOnce() dispatches on the posting stack,
+// without it the worker thread of WorkQueue::init() is woken by a semaphore (std::thread stand-in of CMSIS-RTOS2)
+#include "periph/work_queue.h"
+#include "periph/event_loop.h"
+#include "check.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Project::periph;
+
+#ifdef PERIPH_USE_BARE_METAL
+static const char* build = "bare metal";
+#else
+static const char* build = "rtos";
+#endif
+
+static int64_t nanoseconds() {
+    using namespace std::chrono;
+    return duration_cast<std::chrono::nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static WorkQueue queue = {};
+static std::vector<int64_t> samples;
+static std::atomic<uint32_t> done = {0};
+
+/// work item, the payload is the time of post()
+static void measure(void*, const uint8_t* payload, size_t len) {
+    int64_t now = nanoseconds();
+    int64_t posted;
+    CHECK(len == sizeof(posted), "payload of %zu bytes", len);
+    std::memcpy(&posted, payload, sizeof(posted));
+    samples.push_back(now - posted);
+    done.fetch_add(1, std::memory_order_release);
+}
+
+/// the posting thread stands in for the interrupt, one item in flight at a time
+static void run(uint32_t n) {
+    samples.clear();
+    samples.reserve(n);
+    done.store(0);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        int64_t posted = nanoseconds();
+        CHECK(queue.post(measure, nullptr, &posted, sizeof(posted)), "post %u dropped", i);
+
+        #ifdef PERIPH_USE_BARE_METAL
+        EventLoop::runOnce();
+        #else
+        while (done.load(std::memory_order_acquire) <= i)
+            std::this_thread::yield();
+        #endif
+    }
+}
+
+static int64_t percentile(double p) {
+    return samples[size_t(p * double(samples.size() - 1))];
+}
+
+int main() {
+    constexpr uint32_t n = 200'000;
+    queue.init();
+
+    run(n / 10); // warm up caches and the worker thread
+    run(n);
+
+    CHECK(samples.size() == n, "%zu of %u items run", samples.size(), n);
+    CHECK(queue.dropped == 0, "%u items dropped", queue.dropped);
+    std::sort(samples.begin(), samples.end());
+    std::printf("%-12s %8u items  min %6lld ns  median %6lld ns  p99 %7lld ns  max %9lld ns\n", build, n,
+        (long long) samples.front(), (long long) percentile(0.5), (long long) percentile(0.99), (long long) samples.back());
+
+    return checkResult();
+}
@@ -0,0 +1,165 @@
+// PWMBitEncoder, PWMStream and PWM::init against a simulated timer and circular DMA,
+// checks the high time of each encoded bit and the idle tail of WS2812 and DShot600 frames
+#include "periph/pwm_stream.h"
+#include "check.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace Project::periph;
+
+/// one timer channel with a circular DMA stream into its compare register
+static struct {
+    const uint32_t* data = nullptr;
+    uint16_t len = 0;
+    uint16_t index = 0;
+    bool running = false;
+    int starts = 0;
+} dma;
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start_DMA(TIM_HandleTypeDef*, uint32_t, const uint32_t* data, uint16_t len) {
+    if (dma.running)
+        return HAL_BUSY;
+    dma = { data, len, 0, true, dma.starts + 1 };
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_DMA(TIM_HandleTypeDef*, uint32_t) { dma.running = false; return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_PWM_Start_IT(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_IT(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_OC_Stop_IT(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_OC_Start_DMA(TIM_HandleTypeDef*, uint32_t, const uint32_t*, uint16_t) { return HAL_ERROR; }
+HAL_StatusTypeDef HAL_TIM_OC_Stop_DMA(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start_IT(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Stop_IT(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start_DMA(TIM_HandleTypeDef*, uint32_t, const uint32_t*, uint16_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Stop_DMA(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_OCN_Start_IT(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_OCN_Stop_IT(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_OCN_Start_DMA(TIM_HandleTypeDef*, uint32_t, const uint32_t*, uint16_t) { return HAL_OK; }
+HAL_StatusTypeDef HAL_TIMEx_OCN_Stop_DMA(TIM_HandleTypeDef*, uint32_t) { return HAL_OK; }
+
+extern "C" void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef* htim);
+extern "C" void HAL_TIM_PWM_PulseFinishedHalfCpltCallback(TIM_HandleTypeDef* htim);
+
+static TIM_TypeDef tim = {};
+static DMA_HandleTypeDef hdma = {};
+static TIM_HandleTypeDef htim = { &tim, HAL_TIM_ACTIVE_CHANNEL_CLEARED, {nullptr, &hdma}, {} };
+
+/// compare values loaded at each update event until the DMA is stopped, with the half and full transfer interrupts
+static std::vector<uint32_t> run(size_t maxPeriods) {
+    std::vector<uint32_t> out;
+    while (dma.running && out.size() < maxPeriods) {
+        out.push_back(dma.data[dma.index++]);
+        htim.Channel = HAL_TIM_ACTIVE_CHANNEL_1;
+        if (dma.index == dma.len / 2) {
+            HAL_TIM_PWM_PulseFinishedHalfCpltCallback(&htim);
+        } else if (dma.index == dma.len) {
+            dma.index = 0;
+            HAL_TIM_PWM_PulseFinishedCallback(&htim);
+        }
+    }
+    return out;
+}
+
+struct Protocol {
+    const char* name;
+    double clock;       ///< timer clock in Hz
+    double bitRate;     ///< bits per second
+    double high0;       ///< high time of bit 0 in s
+    double high1;       ///< high time of bit 1 in s
+    double tolerance;   ///< allowed error of the high time in s
+};
+
+/// stream a frame and check every period against the protocol
+static void frame(const Protocol& p, const uint8_t* data, size_t len, size_t bufferLen) {
+    uint32_t period = uint32_t(std::lround(p.clock / p.bitRate));
+    tim.ARR = period - 1;
+
+    PWM pwm = { .htim=htim, .channel=TIM_CHANNEL_1 };
+    std::vector<uint32_t> buffer(bufferLen);
+    int done = 0;
+    PWMStream stream = { .pwm=pwm, .buffer=buffer.data(), .len=bufferLen, .idlePulse=0,
+        .doneCallback={+[] (void* n) { ++*static_cast<int*>(n); }, &done} };
+
+    PWMBitEncoder encoder = { .data=data, .len=len,
+        .pulse0=uint32_t(std::lround(p.high0 * p.clock)), .pulse1=uint32_t(std::lround(p.high1 * p.clock)) };
+
+    CHECK(stream.start(encoder), "%s: start failed", p.name);
+    CHECK(!stream.start(encoder), "%s: second start while busy", p.name);
+    auto out = run(len * 8 + 4 * bufferLen);
+
+    size_t bits = len * 8;
+    CHECK(done == 1, "%s: done %d times", p.name, done);
+    CHECK(!stream.isBusy && !dma.running, "%s: still running", p.name);
+    CHECK(out.size() >= bits + bufferLen / 2, "%s: %zu periods for %zu bits", p.name, out.size(), bits);
+    CHECK(out.size() <= bits + bufferLen + bufferLen / 2, "%s: %zu periods for %zu bits", p.name, out.size(), bits);
+
+    double worst = 0;
+    for (size_t i = 0; i < bits && i < out.size(); ++i) {
+        bool one = data[i >> 3] & (0x80u >> (i & 7));
+        double high = out[i] / p.clock;
+        double error = std::fabs(high - (one ? p.high1 : p.high0));
+        worst = std::fmax(worst, error);
+        CHECK(error <= p.tolerance, "%s: bit %zu high %.0f ns", p.name, i, high * 1e9);
+        CHECK(out[i] < period, "%s: bit %zu compare %u >= period %u", p.name, i, out[i], period);
+    }
+    for (size_t i = bits; i < out.size(); ++i)
+        CHECK(out[i] == 0, "%s: period %zu after the frame is %u, not idle", p.name, i, out[i]);
+
+    CHECK(PWM::Instances.isEmpty(), "%s: PWM still registered after the stream", p.name);
+    CHECK(TimRouter::find(htim.Instance) == nullptr, "%s: router slot not released", p.name);
+
+    std::printf("%-10s %4zu bits %4zu periods  bit %7.1f ns  worst high time error %5.1f ns\n",
+        p.name, bits, out.size(), period / p.clock * 1e9, worst * 1e9);
+}
+
+/// the encoder alone, MSB first and split over calls
+static void encoder() {
+    const uint8_t data[] = {0xA5, 0x0F};
+    PWMBitEncoder enc = { .data=data, .len=2, .pulse0=1, .pulse1=2 };
+    uint32_t out[16] = {};
+    size_t n = enc(out, 3);
+    n += enc(out + n, 16);
+    const uint32_t expected[16] = {2,1,2,1,1,2,1,2, 1,1,1,1,2,2,2,2};
+    CHECK(n == 16, "encoded %zu values", n);
+    for (size_t i = 0; i < 16; ++i)
+        CHECK(out[i] == expected[i], "value %zu is %u", i, out[i]);
+    CHECK(enc(out, 16) == 0, "encoder did not stop at the end of data");
+}
+
+/// PWM::init starts the DMA with startNow and a buffer
+static void startNow() {
+    PWM pwm = { .htim=htim, .channel=TIM_CHANNEL_1 };
+    uint32_t values[4] = {1, 2, 3, 4};
+    int starts = dma.starts;
+
+    pwm.init({.startNow=true, .dmaBuffer=values, .len=4});
+    CHECK(dma.running && dma.starts == starts + 1 && dma.data == values && dma.len == 4, "startNow did not start the DMA");
+    pwm.deinit();
+    CHECK(!dma.running, "deinit did not stop the DMA");
+    CHECK(PWM::Instances.isEmpty(), "PWM still registered after deinit");
+}
+
+int main() {
+    encoder();
+    startNow();
+
+    // WS2812B: 800 kbit/s, T0H 0.4 us, T1H 0.8 us, +-150 ns
+    const Protocol ws2812 = { "ws2812", 72e6, 800e3, 0.4e-6, 0.8e-6, 150e-9 };
+    // DShot600: 600 kbit/s, T0H 0.625 us, T1H 1.25 us
+    const Protocol dshot = { "dshot600", 168e6, 600e3, 0.625e-6, 1.25e-6, 50e-9 };
+
+    uint8_t leds[3 * 8];
+    for (size_t i = 0; i < sizeof(leds); ++i)
+        leds[i] = uint8_t(i * 37 + 11);
+    frame(ws2812, leds, sizeof(leds), 48);
+    frame(ws2812, leds, 1, 48);             // shorter than a half
+    frame(ws2812, leds, 3, 48);             // exactly one half
+
+    const uint8_t throttle[2] = {0x8A, 0x5C};
+    frame(dshot, throttle, sizeof(throttle), 16);
+
+    return checkResult();
+}
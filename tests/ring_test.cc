@@ -0,0 +1,186 @@
+// producer/consumer stress test of periph/ring.h, reports ops/s
+#include "periph/ring.h"
+#include "check.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Project::periph;
+
+template <typename F>
+static double seconds(F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* name, uint64_t ops, double s) {
+    std::printf("%-32s %12llu ops %8.3f s %8.2f Mops/s\n", name, (unsigned long long) ops, s, ops / s / 1e6);
+}
+
+/// one producer pushes a sequence one element at a time, the consumer checks the order
+static void spscSingle() {
+    constexpr uint32_t n = 20'000'000;
+    auto ring = std::make_unique<SpscRing<uint32_t, 1024>>();
+    uint32_t errors = 0;
+
+    double s = seconds([&] {
+        std::thread producer([&] {
+            for (uint32_t i = 0; i < n;)
+                if (ring->push(i)) ++i; else std::this_thread::yield();
+        });
+        for (uint32_t expected = 0, v; expected < n;) {
+            if (!ring->pop(v)) { std::this_thread::yield(); continue; }
+            if (v != expected) errors++;
+            ++expected;
+        }
+        producer.join();
+    });
+
+    CHECK(errors == 0, "spsc single: %u out of order elements", errors);
+    CHECK(ring->isEmpty(), "spsc single: ring not empty");
+    report("spsc push/pop", n, s);
+}
+
+/// producer fills writeSpan() like a DMA, the consumer drains readSpan()
+static void spscSpans() {
+    constexpr uint32_t n = 50'000'000;
+    auto ring = std::make_unique<SpscRing<uint32_t, 4096>>();
+    uint32_t errors = 0;
+
+    double s = seconds([&] {
+        std::thread producer([&] {
+            for (uint32_t i = 0; i < n;) {
+                auto span = ring->writeSpan();
+                size_t k = span.len < n - i ? span.len : n - i;
+                for (size_t j = 0; j < k; ++j)
+                    span.data[j] = i + uint32_t(j);
+                ring->commit(k);
+                i += uint32_t(k);
+                if (k == 0) std::this_thread::yield();
+            }
+        });
+        for (uint32_t expected = 0; expected < n;) {
+            auto span = ring->readSpan();
+            for (size_t j = 0; j < span.len; ++j)
+                if (span.data[j] != expected + j) errors++;
+            ring->release(span.len);
+            expected += uint32_t(span.len);
+            if (span.len == 0) std::this_thread::yield();
+        }
+        producer.join();
+    });
+
+    CHECK(errors == 0, "spsc spans: %u wrong elements", errors);
+    report("spsc writeSpan/readSpan", n, s);
+}
+
+/// producers tag their elements, the consumer checks each producer's order and the total
+static void mpsc(unsigned producers) {
+    constexpr uint32_t perProducer = 4'000'000;
+    auto ring = std::make_unique<MpscRing<uint32_t, 1024>>();
+    std::vector<uint32_t> next(producers, 0);
+    uint32_t errors = 0;
+    std::atomic<uint32_t> sizeErrors = {0};
+    uint64_t total = uint64_t(perProducer) * producers;
+
+    double s = seconds([&] {
+        std::vector<std::thread> threads;
+        for (unsigned p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (uint32_t i = 0; i < perProducer;) {
+                    if (ring->push(p << 24 | i)) ++i; else std::this_thread::yield();
+                    // producers read size(), e.g. WorkQueue::highWater
+                    if (ring->size() > ring->capacity) sizeErrors++;
+                }
+            });
+        }
+        for (uint64_t popped = 0; popped < total;) {
+            uint32_t v;
+            if (!ring->pop(v)) { std::this_thread::yield(); continue; }
+            uint32_t p = v >> 24;
+            if (p >= producers || (v & 0xFFFFFF) != next[p]) errors++;
+            else next[p]++;
+            ++popped;
+        }
+        for (auto& t : threads)
+            t.join();
+    });
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "mpsc push/pop, %u producers", producers);
+    CHECK(errors == 0, "%s: %u out of order elements", name, errors);
+    CHECK(sizeErrors == 0, "%s: size() above capacity %u times", name, sizeErrors.load());
+    CHECK(ring->size() == 0, "%s: ring not empty", name);
+    report(name, total, s);
+}
+
+/// emplace() reserves then fills, the consumer must not see a cell before it is published
+static void mpscEmplace() {
+    constexpr uint32_t perProducer = 2'000'000;
+    constexpr unsigned producers = 4;
+    struct Item { uint32_t a, b, c, d; };
+    auto ring = std::make_unique<MpscRing<Item, 256>>();
+    uint32_t errors = 0;
+
+    double s = seconds([&] {
+        std::vector<std::thread> threads;
+        for (unsigned p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (uint32_t i = 0; i < perProducer;) {
+                    uint32_t v = p << 24 | i;
+                    if (ring->emplace([v] (Item& item) { item = {v, ~v, v * 3, v ^ 0x5A5A5A5A}; })) ++i; else std::this_thread::yield();
+                }
+            });
+        }
+        for (uint64_t popped = 0; popped < uint64_t(perProducer) * producers;) {
+            Item* item = ring->front();
+            if (item == nullptr) { std::this_thread::yield(); continue; }
+            uint32_t v = item->a;
+            if (item->b != ~v || item->c != v * 3 || item->d != (v ^ 0x5A5A5A5A)) errors++;
+            ring->pop();
+            ++popped;
+        }
+        for (auto& t : threads)
+            t.join();
+    });
+
+    CHECK(errors == 0, "mpsc emplace: %u torn items", errors);
+    report("mpsc emplace/front, 4 producers", uint64_t(perProducer) * producers, s);
+}
+
+/// free running indices wrap around 2^32
+static void wrap() {
+    SpscRing<uint32_t, 8> spsc = {};
+    spsc.head = spsc.tail = 0xFFFFFFFC;
+    for (uint32_t i = 0; i < 100; ++i) {
+        CHECK(spsc.push(i), "spsc wrap: push %u failed", i);
+        uint32_t v = 0;
+        CHECK(spsc.pop(v) && v == i, "spsc wrap: pop %u returned %u", i, v);
+    }
+
+    MpscRing<uint32_t, 8> mpsc = {};
+    for (uint32_t i = 0; i < 8; ++i)
+        CHECK(mpsc.push(i), "mpsc full: push %u failed", i);
+    CHECK(!mpsc.push(8), "mpsc full: push into a full ring succeeded");
+    for (uint32_t i = 0, v = ~0u; i < 8; ++i)
+        CHECK(mpsc.pop(v) && v == i, "mpsc full: pop %u returned %u", i, v);
+}
+
+int main() {
+    unsigned cores = std::thread::hardware_concurrency();
+    std::printf("%u hardware threads\n", cores);
+
+    wrap();
+    spscSingle();
+    spscSpans();
+    mpsc(1);
+    mpsc(2);
+    mpsc(4);
+    mpscEmplace();
+
+    std::printf(failures ? "%d failures\n" : "passed\n", failures);
+    return checkResult();
+}
@@ -0,0 +1,33 @@
+#ifndef PERIPH_TESTS_STUB_ETL_FUNCTION_H
+#define PERIPH_TESTS_STUB_ETL_FUNCTION_H
+
+// the part of etl::Function used by periph: a function pointer bound to a context
+
+namespace Project::etl {
+    template <typename Signature, typename Context> class Function;
+
+    template <typename R, typename... Args, typename Context>
+    class Function<R(Args...), Context> {
+    public:
+        using Fn = R(*)(Context, Args...);
+
+        constexpr Function() = default;
+        template <typename F, typename C>
+        constexpr Function(F fn, C* context) : fn(fn), context(context) {}
+
+        R operator()(Args... args) const {
+            if (fn) return fn(context, args...);
+            return R();
+        }
+
+        explicit operator bool() const { return fn != nullptr; }
+        bool operator==(const Function& other) const { return fn == other.fn && context == other.context; }
+        bool operator!=(const Function& other) const { return !(*this == other); }
+
+    private:
+        Fn fn = nullptr;
+        Context context = {};
+    };
+}
+
+#endif // PERIPH_TESTS_STUB_ETL_FUNCTION_H
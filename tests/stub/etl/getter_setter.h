@@ -0,0 +1,34 @@
+#ifndef PERIPH_TESTS_STUB_ETL_GETTER_SETTER_H
+#define PERIPH_TESTS_STUB_ETL_GETTER_SETTER_H
+
+// property made of a getter and a setter function, and etl::bind of a member function
+
+#include "etl/function.h"
+
+namespace Project::etl {
+    template <typename T, typename Getter, typename Setter>
+    struct GetterSetter {
+        Getter get;
+        Setter set;
+
+        operator T() const { return get(); }
+        const GetterSetter& operator=(T value) const { set(value); return *this; }
+    };
+
+    template <auto Method, typename Class> struct Bound;
+
+    template <typename Class, typename R, typename... Args, R (Class::*Method)(Args...) const>
+    struct Bound<Method, Class> {
+        Class* object;
+
+        template <typename Context>
+        operator Function<R(Args...), Context>() const {
+            return {+[] (Context self, Args... args) -> R { return (static_cast<const Class*>(self)->*Method)(args...); }, object};
+        }
+    };
+
+    template <auto Method, typename Class>
+    Bound<Method, Class> bind(Class* object) { return {object}; }
+}
+
+#endif // PERIPH_TESTS_STUB_ETL_GETTER_SETTER_H
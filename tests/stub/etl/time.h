@@ -0,0 +1,19 @@
+#ifndef PERIPH_TESTS_STUB_ETL_TIME_H
+#define PERIPH_TESTS_STUB_ETL_TIME_H
+
+// etl::Time counts kernel ticks, the host stand-in runs at 1 kHz
+
+#include <cstdint>
+
+namespace Project::etl {
+    struct Time { uint32_t tick; };
+
+    namespace time {
+        inline constexpr Time infinite = {0xFFFFFFFF};
+        inline constexpr Time immediate = {0};
+        constexpr Time milliseconds(uint32_t ms) { return {ms}; }
+        constexpr Time seconds(uint32_t s) { return {s * 1000}; }
+    }
+}
+
+#endif // PERIPH_TESTS_STUB_ETL_TIME_H
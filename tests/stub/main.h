@@ -0,0 +1,26 @@
+#ifndef PERIPH_TESTS_STUB_MAIN_H
+#define PERIPH_TESTS_STUB_MAIN_H
+
+// host stand-in for the cubeMX main.h, no HAL module is enabled.
+// interrupts are never masked, the tests only post from the thread that dispatches or use the lock-free rings
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#define UNUSED(x) ((void)(x))
+
+inline uint32_t HAL_GetTick() {
+    using namespace std::chrono;
+    return uint32_t(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+inline uint32_t __get_PRIMASK() { return 0; }
+inline void __set_PRIMASK(uint32_t) {}
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+inline void __WFI() { std::this_thread::yield(); }
+inline void __DMB() { std::atomic_thread_fence(std::memory_order_seq_cst); }
+
+#endif // PERIPH_TESTS_STUB_MAIN_H
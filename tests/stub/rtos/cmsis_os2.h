@@ -0,0 +1,68 @@
+#ifndef PERIPH_TESTS_STUB_CMSIS_OS2_H
+#define PERIPH_TESTS_STUB_CMSIS_OS2_H
+
+// the CMSIS-RTOS2 calls used by periph, backed by std::thread.
+// a semaphore release wakes the waiting thread through the host scheduler, standing in for the RTOS context switch
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+typedef enum { osPriorityNormal = 24, osPriorityAboveNormal = 32, osPriorityHigh = 40 } osPriority_t;
+typedef void (*osThreadFunc_t)(void* argument);
+
+#define osWaitForever 0xFFFFFFFFU
+#define osOK 0
+
+struct osThreadAttr_t {
+    const char* name;
+    uint32_t attr_bits;
+    void* cb_mem;
+    uint32_t cb_size;
+    void* stack_mem;
+    uint32_t stack_size;
+    osPriority_t priority;
+};
+
+struct osSemaphoreStub {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t count;
+    uint32_t max;
+};
+
+typedef osSemaphoreStub* osSemaphoreId_t;
+typedef std::thread* osThreadId_t;
+
+inline osSemaphoreId_t osSemaphoreNew(uint32_t max, uint32_t initial, const void*) {
+    auto s = new osSemaphoreStub();
+    s->count = initial;
+    s->max = max;
+    return s;
+}
+
+inline int osSemaphoreRelease(osSemaphoreId_t s) {
+    {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (s->count < s->max)
+            s->count++;
+    }
+    s->cv.notify_one();
+    return osOK;
+}
+
+inline int osSemaphoreAcquire(osSemaphoreId_t s, uint32_t) {
+    std::unique_lock<std::mutex> lock(s->mutex);
+    s->cv.wait(lock, [s] { return s->count > 0; });
+    s->count--;
+    return osOK;
+}
+
+inline osThreadId_t osThreadNew(osThreadFunc_t fn, void* argument, const osThreadAttr_t*) {
+    auto t = new std::thread(fn, argument);
+    t->detach();
+    return t;
+}
+
+#endif // PERIPH_TESTS_STUB_CMSIS_OS2_H
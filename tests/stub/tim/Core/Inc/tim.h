@@ -0,0 +1,6 @@
+#ifndef PERIPH_TESTS_STUB_TIM_H
+#define PERIPH_TESTS_STUB_TIM_H
+
+// cubeMX declares the TIM handles here, the tests define their own
+
+#endif // PERIPH_TESTS_STUB_TIM_H
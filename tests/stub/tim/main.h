@@ -0,0 +1,96 @@
+#ifndef PERIPH_TESTS_STUB_TIM_MAIN_H
+#define PERIPH_TESTS_STUB_TIM_MAIN_H
+
+// host stand-in for the cubeMX main.h with the TIM module enabled.
+// the HAL TIM functions are only declared, a test defines them to simulate the timer and its DMA
+
+#include "../main.h"
+
+#define HAL_TIM_MODULE_ENABLED
+
+typedef enum { HAL_OK = 0, HAL_ERROR = 1, HAL_BUSY = 2, HAL_TIMEOUT = 3 } HAL_StatusTypeDef;
+
+typedef struct {
+    volatile uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2, CCR3, CCR4, BDTR;
+} TIM_TypeDef;
+
+typedef struct { volatile uint32_t CCR, CNDTR; } DMA_Channel_TypeDef;
+typedef struct { DMA_Channel_TypeDef* Instance; } DMA_HandleTypeDef;
+
+typedef enum {
+    HAL_TIM_ACTIVE_CHANNEL_1 = 0x01,
+    HAL_TIM_ACTIVE_CHANNEL_2 = 0x02,
+    HAL_TIM_ACTIVE_CHANNEL_3 = 0x04,
+    HAL_TIM_ACTIVE_CHANNEL_4 = 0x08,
+    HAL_TIM_ACTIVE_CHANNEL_5 = 0x10,
+    HAL_TIM_ACTIVE_CHANNEL_6 = 0x20,
+    HAL_TIM_ACTIVE_CHANNEL_CLEARED = 0x00,
+} HAL_TIM_ActiveChannel;
+
+typedef struct { uint32_t CounterMode, Period, RepetitionCounter; } TIM_Base_InitTypeDef;
+
+typedef struct {
+    TIM_TypeDef* Instance;
+    HAL_TIM_ActiveChannel Channel;
+    DMA_HandleTypeDef* hdma[7];
+    TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+#define TIM_CHANNEL_1 0x00000000U
+#define TIM_CHANNEL_2 0x00000004U
+#define TIM_CHANNEL_3 0x00000008U
+#define TIM_CHANNEL_4 0x0000000CU
+#define TIM_CHANNEL_5 0x00000010U
+#define TIM_CHANNEL_6 0x00000014U
+#define TIM_DMA_ID_CC1 ((uint16_t) 0x0001)
+#define TIM_IT_UPDATE 0x00000001U
+
+#define TIM_CR1_CEN 0x0001U
+#define TIM_CR1_UDIS 0x0002U
+#define TIM_CR1_DIR 0x0010U
+#define TIM_CR1_CMS 0x0060U
+#define TIM_CR1_ARPE 0x0080U
+#define TIM_CR2_MMS 0x0070U
+#define TIM_EGR_UG 0x0001U
+#define TIM_CCMR1_OC1PE 0x0008U
+#define TIM_BDTR_DTG 0x00FFU
+#define TIM_BDTR_BKE 0x1000U
+#define TIM_BDTR_BKP 0x2000U
+#define TIM_COUNTERMODE_CENTERALIGNED1 TIM_CR1_CMS_0
+#define TIM_CR1_CMS_0 0x0020U
+#define TIM_BREAKPOLARITY_LOW 0x0000U
+#define TIM_BREAKPOLARITY_HIGH TIM_BDTR_BKP
+#define TIM_TRGO_UPDATE 0x0020U
+#define TIM_TRGO_OC4REF 0x0070U
+#define TIM_DMABASE_CCR1 0x000DU
+#define TIM_DMA_UPDATE 0x0100U
+
+#define __HAL_TIM_ENABLE(h) ((h)->Instance->CR1 |= TIM_CR1_CEN)
+#define __HAL_TIM_DISABLE(h) ((h)->Instance->CR1 &= ~TIM_CR1_CEN)
+#define __HAL_TIM_ENABLE_IT(h, it) ((h)->Instance->DIER |= (it))
+#define __HAL_TIM_DISABLE_IT(h, it) ((h)->Instance->DIER &= ~(it))
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Stop(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStart(TIM_HandleTypeDef* htim, uint32_t base, uint32_t source, uint32_t* data, uint32_t len);
+HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStop(TIM_HandleTypeDef* htim, uint32_t source);
+HAL_StatusTypeDef HAL_TIM_PWM_Start_IT(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_IT(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIM_PWM_Start_DMA(TIM_HandleTypeDef* htim, uint32_t channel, const uint32_t* data, uint16_t len);
+HAL_StatusTypeDef HAL_TIM_PWM_Stop_DMA(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIM_OC_Stop_IT(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIM_OC_Start_DMA(TIM_HandleTypeDef* htim, uint32_t channel, const uint32_t* data, uint16_t len);
+HAL_StatusTypeDef HAL_TIM_OC_Stop_DMA(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start_IT(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Stop_IT(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start_DMA(TIM_HandleTypeDef* htim, uint32_t channel, const uint32_t* data, uint16_t len);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Stop_DMA(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIMEx_OCN_Start_IT(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIMEx_OCN_Stop_IT(TIM_HandleTypeDef* htim, uint32_t channel);
+HAL_StatusTypeDef HAL_TIMEx_OCN_Start_DMA(TIM_HandleTypeDef* htim, uint32_t channel, const uint32_t* data, uint16_t len);
+HAL_StatusTypeDef HAL_TIMEx_OCN_Stop_DMA(TIM_HandleTypeDef* htim, uint32_t channel);
+
+#endif // PERIPH_TESTS_STUB_TIM_MAIN_H
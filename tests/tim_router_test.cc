@@ -0,0 +1,69 @@
+// TimRouter slot allocation, release on detach, rejected double attach and cleared channel events
+#include "periph/tim_router.h"
+#include "check.h"
+#include <cstdio>
+
+using namespace Project::periph;
+
+static TIM_TypeDef tim[PERIPH_TIM_ROUTER_MAX_TIMERS + 1] = {};
+static TIM_HandleTypeDef htim[PERIPH_TIM_ROUTER_MAX_TIMERS + 1] = {};
+
+static TimRouter::Callback counter(int& n) { return {+[] (void* n) { ++*static_cast<int*>(n); }, &n}; }
+
+/// the second driver on a channel is refused, the first keeps its events
+static void conflict() {
+    int ic = 0, encoder = 0;
+    CHECK(TimRouter::attach(htim[0], TimRouter::eventCapture, TIM_CHANNEL_1, counter(ic)), "first attach failed");
+    CHECK(!TimRouter::attach(htim[0], TimRouter::eventCapture, TIM_CHANNEL_1, counter(encoder)), "second attach replaced the handler");
+    CHECK(TimRouter::attach(htim[0], TimRouter::eventCapture, TIM_CHANNEL_2, counter(encoder)), "other channel refused");
+
+    htim[0].Channel = HAL_TIM_ACTIVE_CHANNEL_1;
+    TimRouter::dispatch(&htim[0], TimRouter::eventCapture);
+    CHECK(ic == 1 && encoder == 0, "channel 1 routed to ic %d encoder %d", ic, encoder);
+
+    htim[0].Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+    TimRouter::dispatch(&htim[0], TimRouter::eventCapture);
+    CHECK(ic == 1 && encoder == 0, "cleared channel routed to ic %d encoder %d", ic, encoder);
+
+    // channel 5 and 6 have no handlers, they must not alias channel 1 and 2
+    CHECK(!TimRouter::attach(htim[0], TimRouter::eventPulse, TIM_CHANNEL_5, counter(encoder)), "channel 5 accepted");
+    htim[0].Channel = HAL_TIM_ACTIVE_CHANNEL_5;
+    TimRouter::dispatch(&htim[0], TimRouter::eventCapture);
+    htim[0].Channel = HAL_TIM_ACTIVE_CHANNEL_6;
+    TimRouter::dispatch(&htim[0], TimRouter::eventCapture);
+    CHECK(ic == 1 && encoder == 0, "channel 5/6 routed to ic %d encoder %d", ic, encoder);
+
+    TimRouter::detach(htim[0], TimRouter::eventCapture, TIM_CHANNEL_1);
+    CHECK(TimRouter::find(&tim[0]) != nullptr, "slot released with a handler left");
+    TimRouter::detach(htim[0], TimRouter::eventCapture, TIM_CHANNEL_2);
+    CHECK(TimRouter::find(&tim[0]) == nullptr, "slot kept without handlers");
+}
+
+/// every slot can be used again after its timer detached
+static void reuse() {
+    int n = 0;
+    for (int round = 0; round < 3; ++round) {
+        for (size_t i = 0; i < TimRouter::maxTimers; ++i)
+            CHECK(TimRouter::attach(htim[i], TimRouter::eventUpdate, 0, counter(n)), "round %d: timer %zu refused", round, i);
+        CHECK(!TimRouter::attach(htim[TimRouter::maxTimers], TimRouter::eventUpdate, 0, counter(n)), "more timers than slots");
+
+        for (size_t i = 0; i < TimRouter::maxTimers; ++i)
+            TimRouter::dispatch(&htim[i], TimRouter::eventUpdate);
+        CHECK(n == int(TimRouter::maxTimers) * (round + 1), "round %d: %d updates", round, n);
+
+        for (size_t i = 0; i < TimRouter::maxTimers; ++i)
+            TimRouter::detach(htim[i], TimRouter::eventUpdate, 0);
+    }
+
+    TimRouter::detach(htim[0], TimRouter::eventTrigger, 0);
+    CHECK(TimRouter::find(&tim[0]) == nullptr, "detach allocated a slot");
+}
+
+int main() {
+    for (size_t i = 0; i < PERIPH_TIM_ROUTER_MAX_TIMERS + 1; ++i)
+        htim[i].Instance = &tim[i];
+
+    conflict();
+    reuse();
+    return checkResult();
+}
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""Pretty-print a periph/trace.h dump.
+
+usage:
+    trace_decode.py dump.bin
+    trace_decode.py /dev/ttyACM0 --baud 115200   (requires pyserial)
+    cat dump.bin | trace_decode.py -
+"""
+
+import argparse
+import struct
+import sys
+
+SOURCES = [
+    "uart", "uart user",
+    "can", "can user",
+    "adc", "adc user",
+    "i2s", "i2s user",
+    "pwm", "pwm user",
+    "input capture", "input capture user",
+    "tim", "tim user",
+    "exti", "exti user",
+    "usb", "usb user",
+    "work queue",   # version 2, latency from post to dispatch
+]
+
+# sources of each dump version
+SOURCE_COUNT = {1: 18, 2: 19}
+
+HEADER = struct.Struct("<4sBBHI")
+RECORD = struct.Struct("<B3xIIIQ32I")
+
+
+def source_name(index, version):
+    count = SOURCE_COUNT[version]
+    if index < count:
+        return SOURCES[index]
+    return f"app {index - count}"
+
+
+def read_exact(stream, n):
+    data = b""
+    while len(data) < n:
+        chunk = stream.read(n - len(data))
+        if not chunk:
+            raise EOFError(f"truncated dump, expected {n} bytes, got {len(data)}")
+        data += chunk
+    return data
+
+
+def sync(stream):
+    """skip bytes until the magic, e.g. log output preceding the dump"""
+    window = b""
+    while window != b"PTRC":
+        byte = stream.read(1)
+        if not byte:
+            raise EOFError("no trace dump found")
+        window = (window + byte)[-4:]
+    return window
+
+
+def decode(stream):
+    header = sync(stream) + read_exact(stream, HEADER.size - 4)
+    _, version, count, record_size, clock = HEADER.unpack(header)
+    if version not in SOURCE_COUNT:
+        raise ValueError(f"unsupported trace version {version}")
+
+    records = []
+    for _ in range(count):
+        raw = read_exact(stream, record_size)
+        source, n, lo, hi, total, *histogram = RECORD.unpack(raw[:RECORD.size])
+        records.append((source_name(source, version), n, lo, hi, total, histogram))
+    return clock, records
+
+
+def us(cycles, clock):
+    return cycles * 1e6 / clock if clock else float("nan")
+
+
+def bucket_range(i):
+    return (0, 0) if i == 0 else (1 << (i - 1), (1 << i) - 1)
+
+
+def show(clock, records, histogram):
+    print(f"core clock {clock / 1e6:g} MHz, {len(records)} sources")
+    print(f"{'source':<20} {'count':>10} {'min':>10} {'mean':>10} {'max':>10} {'max us':>10}")
+    for source, n, lo, hi, total, _ in records:
+        mean = total // n if n else 0
+        print(f"{source:<20} {n:>10} {lo:>10} {mean:>10} {hi:>10} {us(hi, clock):>10.2f}")
+
+    if not histogram:
+        return
+
+    for source, n, _, _, _, buckets in records:
+        print(f"\n{source}")
+        peak = max(buckets) or 1
+        for i, hits in enumerate(buckets):
+            if hits == 0:
+                continue
+            lo, hi = bucket_range(i)
+            bar = "#" * max(1, hits * 40 // peak)
+            print(f"  {lo:>10} - {hi:<10} {hits:>10} {bar}")
+
+
+def open_input(path, baud):
+    if path == "-":
+        return sys.stdin.buffer
+    if path.startswith("/dev/") or path.upper().startswith("COM"):
+        import serial
+        return serial.Serial(path, baud, timeout=5)
+    return open(path, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="dump file, serial port, or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baudrate")
+    parser.add_argument("--no-histogram", action="store_true", help="print the summary table only")
+    args = parser.parse_args()
+
+    clock, records = decode(open_input(args.input, args.baud))
+    show(clock, records, not args.no_histogram)
+
+
+if __name__ == "__main__":
+    main()